@@ -0,0 +1,378 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+/**
+   @file
+   @brief Assembly of mortar / projection matrices over the intersections of a GridGlue
+ */
+
+#ifndef DUNE_GRIDGLUE_COUPLINGMATRIXASSEMBLER_HH
+#define DUNE_GRIDGLUE_COUPLINGMATRIXASSEMBLER_HH
+
+#include <vector>
+#include <algorithm>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/grid-glue/common/parallelfor.hh>
+#include <dune/grid-glue/adapter/gridglue.hh>
+
+namespace Dune {
+  namespace GridGlue {
+
+    /** @brief A sparse matrix in compressed row storage */
+    template<class T>
+    struct CSRMatrix
+    {
+      CSRMatrix() : rows(0), cols(0) {}
+
+      /** \brief number of nonzero entries */
+      std::size_t nnz() const
+      {
+        return colIndex.size();
+      }
+
+      /** \brief position of the entry (row,col) in colIndex and values, or nnz() if it is not in the pattern */
+      std::size_t find(std::size_t row, std::size_t col) const
+      {
+        std::vector<std::size_t>::const_iterator begin = colIndex.begin() + rowStart[row];
+        std::vector<std::size_t>::const_iterator end   = colIndex.begin() + rowStart[row+1];
+        std::vector<std::size_t>::const_iterator it = std::lower_bound(begin, end, col);
+        return (it != end && *it == col) ? std::size_t(it - colIndex.begin()) : nnz();
+      }
+
+      std::size_t rows;
+      std::size_t cols;
+
+      /// @brief the entries of row i are stored at the positions rowStart[i] ... rowStart[i+1]-1
+      std::vector<std::size_t> rowStart;
+
+      /// @brief the column of each entry, sorted within each row
+      std::vector<std::size_t> colIndex;
+
+      /// @brief the value of each entry
+      std::vector<T> values;
+    };
+
+    /**
+       @brief Assemble the coupling matrix \f$ M_{ij} = \int_\Gamma \phi_i \psi_j \f$ over a GridGlue
+
+       The rows of the matrix belong to the basis functions \f$ \phi_i \f$ on the inside
+       patch I, the columns to the basis functions \f$ \psi_j \f$ on the outside patch.
+       The basis functions are provided by the user through evaluator objects with the interface
+       \code
+       struct Basis
+       {
+         // total number of basis functions
+         std::size_t size() const;
+         // number of basis functions with support on element e
+         unsigned int size(const Element& e) const;
+         // global index of the i'th basis function of element e
+         std::size_t index(const Element& e, unsigned int i) const;
+         // values of the basis functions of e at the position x in local coordinates of e
+         void evaluate(const Element& e, const LocalCoordinate& x, std::vector<ctype>& values) const;
+       };
+       \endcode
+       evaluate() has to be safe to call from several threads at once.
+
+       The assembly is split into a symbolic phase, setupPattern(), which computes the
+       sparsity pattern and the position of each local contribution in it, and a numeric
+       phase, assemble().  The pattern stays valid as long as the intersections of the
+       GridGlue are not rebuilt, so reassembling after a change of the geometry only
+       costs the numeric phase.
+
+       The numeric phase first computes the local contributions of the intersections
+       in parallel, each into its own slots, and then sums up the contributions to
+       each matrix entry, again in parallel over the entries.  No two threads write
+       to the same value, and the result does not depend on the number of threads.
+
+       \tparam GlueType the GridGlue type
+       \tparam I the patch whose basis functions belong to the rows
+     */
+    template<class GlueType, int I = 0>
+    class CouplingMatrixAssembler
+    {
+      typedef typename GlueType::Grid0Patch P0;
+      typedef typename GlueType::Grid1Patch P1;
+
+    public:
+
+      typedef QuadraturePoints<P0,P1,I> Points;
+      typedef typename Points::ctype ctype;
+      typedef typename Points::QuadratureRule QuadratureRule;
+      typedef CSRMatrix<ctype> Matrix;
+
+      typedef Dune::GridGlue::Intersection<P0,P1,I,1-I> Intersection;
+
+      CouplingMatrixAssembler(const GlueType& glue)
+        : glue_(glue)
+      {}
+
+      /**
+       * @brief compute the sparsity pattern of the coupling matrix
+       *
+       * @param insideBasis evaluator for the basis on patch I
+       * @param outsideBasis evaluator for the basis on the other patch
+       * @param matrix will be set up with the pattern, all values are zero
+       */
+      template<class InsideBasis, class OutsideBasis>
+      void setupPattern(const InsideBasis& insideBasis, const OutsideBasis& outsideBasis, Matrix& matrix);
+
+      /**
+       * @brief compute the entries of the coupling matrix
+       *
+       * @param insideBasis evaluator for the basis on patch I
+       * @param outsideBasis evaluator for the basis on the other patch
+       * @param quad the quadrature rule on the intersections
+       * @param matrix a matrix set up by setupPattern(), the values are overwritten
+       */
+      template<class InsideBasis, class OutsideBasis>
+      void assemble(const InsideBasis& insideBasis, const OutsideBasis& outsideBasis,
+                    const QuadratureRule& quad, Matrix& matrix);
+
+    private:
+
+      /** \brief compute the local contributions of a range of blocks */
+      template<class InsideBasis, class OutsideBasis>
+      struct AssembleChunk
+      {
+        AssembleChunk(const CouplingMatrixAssembler& assembler,
+                      const InsideBasis& insideBasis, const OutsideBasis& outsideBasis,
+                      std::vector<ctype>& contributions, std::vector<char>& sizeMismatch)
+          : assembler_(assembler), insideBasis_(insideBasis), outsideBasis_(outsideBasis),
+            contributions_(contributions), sizeMismatch_(sizeMismatch)
+        {}
+
+        void operator() (std::size_t begin, std::size_t end) const;
+
+        const CouplingMatrixAssembler& assembler_;
+        const InsideBasis& insideBasis_;
+        const OutsideBasis& outsideBasis_;
+        std::vector<ctype>& contributions_;
+        std::vector<char>& sizeMismatch_;
+      };
+
+      /** \brief sum up the contributions to a range of matrix entries */
+      struct GatherChunk
+      {
+        GatherChunk(const CouplingMatrixAssembler& assembler, Matrix& matrix)
+          : assembler_(assembler), matrix_(matrix)
+        {}
+
+        void operator() (std::size_t begin, std::size_t end) const
+        {
+          for (std::size_t m = begin; m < end; ++m)
+          {
+            ctype value = 0;
+            for (std::size_t s = assembler_.gatherStart_[m]; s < assembler_.gatherStart_[m+1]; ++s)
+              value += assembler_.contributions_[assembler_.gatherSlots_[s]];
+            matrix_.values[m] = value;
+          }
+        }
+
+        const CouplingMatrixAssembler& assembler_;
+        Matrix& matrix_;
+      };
+
+      const GlueType& glue_;
+
+      /// @brief the owned intersections with both entities available, in the order of the quadrature point blocks
+      std::vector<unsigned int> intersections_;
+
+      /// @brief the number of inside and outside basis functions of each block
+      std::vector<unsigned int> insideSizes_;
+      std::vector<unsigned int> outsideSizes_;
+
+      /// @brief the local contributions of block b go to the values at the positions
+      ///        entries_[entryStart_[b]] ... entries_[entryStart_[b+1]-1], outside index running fastest
+      std::vector<std::size_t> entryStart_;
+      std::vector<std::size_t> entries_;
+
+      /// @brief the slots in contributions_ that add up to matrix entry m are
+      ///        gatherSlots_[gatherStart_[m]] ... gatherSlots_[gatherStart_[m+1]-1]
+      std::vector<std::size_t> gatherStart_;
+      std::vector<std::size_t> gatherSlots_;
+
+      /// @brief the local contributions, in the order of entries_
+      std::vector<ctype> contributions_;
+
+      /// @brief the quadrature points, kept to avoid reallocation
+      Points points_;
+    };
+
+    template<class GlueType, int I>
+    template<class InsideBasis, class OutsideBasis>
+    void CouplingMatrixAssembler<GlueType, I>::setupPattern(const InsideBasis& insideBasis,
+                                                            const OutsideBasis& outsideBasis,
+                                                            Matrix& matrix)
+    {
+      intersections_.clear();
+      insideSizes_.clear();
+      outsideSizes_.clear();
+      entryStart_.assign(1, 0);
+
+      // the global indices of the basis functions of each block
+      std::vector<std::size_t> insideIndices;
+      std::vector<std::size_t> outsideIndices;
+      std::vector<std::size_t> insideStart(1, 0);
+      std::vector<std::size_t> outsideStart(1, 0);
+
+      for (unsigned int i = 0; i < glue_.size(); ++i)
+      {
+        // intersections owned by another rank are assembled there
+        if (!glue_.isOwner(i))
+          continue;
+        const Intersection intersection = glue_.template getIntersection<I>(i);
+        if (!intersection.self() || !intersection.neighbor())
+          continue;
+
+        typename Intersection::InsideEntityPointer inside = intersection.inside();
+        typename Intersection::OutsideEntityPointer outside = intersection.outside();
+
+        const unsigned int nInside = insideBasis.size(*inside);
+        const unsigned int nOutside = outsideBasis.size(*outside);
+
+        for (unsigned int k = 0; k < nInside; ++k)
+          insideIndices.push_back(insideBasis.index(*inside, k));
+        for (unsigned int k = 0; k < nOutside; ++k)
+          outsideIndices.push_back(outsideBasis.index(*outside, k));
+
+        intersections_.push_back(i);
+        insideSizes_.push_back(nInside);
+        outsideSizes_.push_back(nOutside);
+        insideStart.push_back(insideIndices.size());
+        outsideStart.push_back(outsideIndices.size());
+        entryStart_.push_back(entryStart_.back() + nInside*nOutside);
+      }
+
+      // collect the columns of each row
+      std::vector<std::vector<std::size_t> > rowColumns(insideBasis.size());
+      for (std::size_t b = 0; b < intersections_.size(); ++b)
+        for (std::size_t k = insideStart[b]; k < insideStart[b+1]; ++k)
+          for (std::size_t l = outsideStart[b]; l < outsideStart[b+1]; ++l)
+            rowColumns[insideIndices[k]].push_back(outsideIndices[l]);
+
+      matrix.rows = insideBasis.size();
+      matrix.cols = outsideBasis.size();
+      matrix.rowStart.resize(matrix.rows+1);
+      matrix.rowStart[0] = 0;
+      matrix.colIndex.clear();
+
+      for (std::size_t r = 0; r < matrix.rows; ++r)
+      {
+        std::vector<std::size_t>& columns = rowColumns[r];
+        std::sort(columns.begin(), columns.end());
+        columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+        matrix.colIndex.insert(matrix.colIndex.end(), columns.begin(), columns.end());
+        matrix.rowStart[r+1] = matrix.colIndex.size();
+
+        // free the memory early
+        std::vector<std::size_t>().swap(columns);
+      }
+
+      matrix.values.assign(matrix.nnz(), ctype(0));
+
+      // remember where each local contribution goes
+      entries_.resize(entryStart_.back());
+      for (std::size_t b = 0; b < intersections_.size(); ++b)
+      {
+        std::size_t e = entryStart_[b];
+        for (std::size_t k = insideStart[b]; k < insideStart[b+1]; ++k)
+          for (std::size_t l = outsideStart[b]; l < outsideStart[b+1]; ++l)
+            entries_[e++] = matrix.find(insideIndices[k], outsideIndices[l]);
+      }
+
+      // invert entries_, counting the contributions to each matrix entry first
+      gatherStart_.assign(matrix.nnz()+1, 0);
+      for (std::size_t e = 0; e < entries_.size(); ++e)
+        ++gatherStart_[entries_[e]+1];
+      for (std::size_t m = 0; m < matrix.nnz(); ++m)
+        gatherStart_[m+1] += gatherStart_[m];
+
+      std::vector<std::size_t> next(gatherStart_.begin(), gatherStart_.end()-1);
+      gatherSlots_.resize(entries_.size());
+      for (std::size_t e = 0; e < entries_.size(); ++e)
+        gatherSlots_[next[entries_[e]]++] = e;
+
+      contributions_.resize(entries_.size());
+    }
+
+    template<class GlueType, int I>
+    template<class InsideBasis, class OutsideBasis>
+    void CouplingMatrixAssembler<GlueType, I>::assemble(const InsideBasis& insideBasis,
+                                                        const OutsideBasis& outsideBasis,
+                                                        const QuadratureRule& quad,
+                                                        Matrix& matrix)
+    {
+      glue_.template quadraturePoints<I>(quad, points_);
+
+      if (points_.intersections != intersections_)
+        DUNE_THROW(Dune::Exception, "The intersections have changed since setupPattern() was called");
+
+      if (matrix.nnz()+1 != gatherStart_.size())
+        DUNE_THROW(Dune::Exception, "The matrix has not been set up by setupPattern()");
+
+      // the local contributions of the intersections...
+      std::vector<char> sizeMismatch(intersections_.size(), 0);
+      parallelFor(intersections_.size(),
+                  AssembleChunk<InsideBasis, OutsideBasis>(*this, insideBasis, outsideBasis,
+                                                           contributions_, sizeMismatch));
+
+      for (std::size_t b = 0; b < intersections_.size(); ++b)
+        if (sizeMismatch[b])
+          DUNE_THROW(Dune::RangeError, "evaluate() returned a different number of values than size() "
+                     "on the elements of intersection " << intersections_[b]);
+
+      // ...are summed up for each matrix entry
+      parallelFor(matrix.nnz(), GatherChunk(*this, matrix));
+    }
+
+    template<class GlueType, int I>
+    template<class InsideBasis, class OutsideBasis>
+    void CouplingMatrixAssembler<GlueType, I>::AssembleChunk<InsideBasis, OutsideBasis>::operator() (std::size_t begin, std::size_t end) const
+    {
+      const Points& points = assembler_.points_;
+
+      std::vector<ctype> insideValues;
+      std::vector<ctype> outsideValues;
+
+      for (std::size_t b = begin; b < end; ++b)
+      {
+        const Intersection intersection = assembler_.glue_.template getIntersection<I>(assembler_.intersections_[b]);
+        typename Intersection::InsideEntityPointer inside = intersection.inside();
+        typename Intersection::OutsideEntityPointer outside = intersection.outside();
+
+        const unsigned int nInside = assembler_.insideSizes_[b];
+        const unsigned int nOutside = assembler_.outsideSizes_[b];
+        const typename std::vector<ctype>::iterator contributions = contributions_.begin() + assembler_.entryStart_[b];
+        std::fill(contributions, contributions + nInside*nOutside, ctype(0));
+
+        for (unsigned int q = 0; q < points.nPoints; ++q)
+        {
+          const std::size_t k = points.index(b, q);
+          const ctype factor = points.weights[q] * points.integrationElements[b];
+
+          insideBasis_.evaluate(*inside, points.inside[k], insideValues);
+          outsideBasis_.evaluate(*outside, points.outside[k], outsideValues);
+
+          // the values have to fit the slots computed from the sizes in setupPattern()
+          if (insideValues.size() != nInside || outsideValues.size() != nOutside)
+          {
+            sizeMismatch_[b] = 1;
+            break;
+          }
+
+          std::size_t e = 0;
+          for (unsigned int i = 0; i < nInside; ++i)
+          {
+            const ctype insideFactor = factor * insideValues[i];
+            for (unsigned int j = 0; j < nOutside; ++j, ++e)
+              contributions[e] += insideFactor * outsideValues[j];
+          }
+        }
+      }
+    }
+
+  } // end namespace GridGlue
+} // end namespace Dune
+
+#endif // DUNE_GRIDGLUE_COUPLINGMATRIXASSEMBLER_HH
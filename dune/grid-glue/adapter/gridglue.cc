@@ -3,11 +3,18 @@
 /*   IMPLEMENTATION OF CLASS   G R I D  G L U E   */
 
 #include "intersection.hh"
+#include <cstring>
 #include <vector>
 #include <iterator>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <numeric>
 #include "gridglue.hh"
 
 #include "../common/multivector.hh"
+#include "../common/patchmessage.hh"
+#include "../common/spacefillingcurve.hh"
 #include "../extractors/vtksurfacewriter.hh"
 
 /** \todo Implement MPI Status check with exception handling */
@@ -15,169 +22,333 @@
 
 #if HAVE_MPI
 namespace {
-  template<typename T>
-  struct MPITypeInfo {};
+  /** \brief MPI tag of the message with patch number 0, patch 1 uses the next tag */
+  static const int patchMessageTag = 1234560;
 
-  template<>
-  struct MPITypeInfo< int >
+  /**
+     Send a packed patch message to another rank without blocking
+
+   * the request is appended to requests, buffer must not be modified until it is completed
+   * patch distinguishes the messages for the two patches
+
+   */
+  inline void MPI_ISendPatch(
+    const std::vector<char> & buffer,
+    int patch,
+    int rank,
+    MPI_Comm comm,
+    std::vector<MPI_Request> & requests
+    )
+  {
+    if (buffer.size() == 0)
+      return;
+    requests.push_back(MPI_Request());
+    int result =
+      MPI_Isend(
+        const_cast<char*>(&(buffer[0])), buffer.size(), MPI_BYTE, rank, patchMessageTag + patch,
+        comm, &requests.back());
+    CheckMPIStatus(result, 0);
+  }
+
+  /** \brief receive buffer for a remote patch */
+  template<typename ctype, int dimworld>
+  struct RemotePatch
   {
-    static const unsigned int size = 1;
-    static inline MPI_Datatype getType()
+    typedef Dune::GridGlue::PatchMessage<ctype, dimworld> Message;
+
+    RemotePatch() : request(MPI_REQUEST_NULL) {}
+
+    /** \brief start receiving the message of the given size with patch number patch from rank */
+    void receive(unsigned int size, int patch, int rank, MPI_Comm comm)
+    {
+      buffer.resize(size);
+      request = MPI_REQUEST_NULL;
+      if (size == 0)
+        return;
+      int result =
+        MPI_Irecv(&(buffer[0]), size, MPI_BYTE, rank, patchMessageTag + patch,
+                  comm, &request);
+      CheckMPIStatus(result, 0);
+    }
+
+    /** \brief wait until the message has arrived and unpack it */
+    void wait()
     {
-      return MPI_INT;
+      MPI_Status status;
+      int result = MPI_Wait(&request, &status);
+      CheckMPIStatus(result, status);
+      Message::unpack(buffer, coords, entities, types);
     }
-    static const int tag = 1234560;
+
+    std::vector<char> buffer;
+    MPI_Request request;
+
+    std::vector<Dune::FieldVector<ctype, dimworld> > coords;
+    std::vector<unsigned int> entities;
+    std::vector<Dune::GeometryType> types;
   };
 
-  template<typename K, int N>
-  struct MPITypeInfo< Dune::FieldVector<K,N> >
+  /** \brief axis-aligned bounding box of a patch, used to find the ranks whose patches may intersect */
+  template<typename ctype, int dimworld>
+  struct PatchBoundingBox
   {
-    static const unsigned int size = N;
-    static inline MPI_Datatype getType()
+    /** \brief an empty box */
+    PatchBoundingBox()
     {
-      return Dune::MPITraits<K>::getType();
+      lower = std::numeric_limits<ctype>::max();
+      upper = -std::numeric_limits<ctype>::max();
     }
-    static const int tag = 1234561;
+
+    /** \brief the box around a set of points, enlarged by tolerance, or the whole space if tolerance is negative */
+    PatchBoundingBox(const std::vector<Dune::FieldVector<ctype,dimworld> > & points, ctype tolerance)
+    {
+      lower = std::numeric_limits<ctype>::max();
+      upper = -std::numeric_limits<ctype>::max();
+      if (points.size() == 0)
+        return;
+
+      // no filtering, the patch may intersect any other one
+      if (tolerance < 0)
+      {
+        lower = -std::numeric_limits<ctype>::max();
+        upper = std::numeric_limits<ctype>::max();
+        return;
+      }
+
+      for (unsigned int i = 0; i < points.size(); ++i)
+        for (int k = 0; k < dimworld; ++k)
+        {
+          lower[k] = std::min(lower[k], points[i][k]);
+          upper[k] = std::max(upper[k], points[i][k]);
+        }
+
+      // be robust against rounding
+      Dune::FieldVector<ctype,dimworld> diagonal = upper - lower;
+      tolerance += 1e-8 * diagonal.two_norm();
+      for (int k = 0; k < dimworld; ++k)
+      {
+        lower[k] -= tolerance;
+        upper[k] += tolerance;
+      }
+    }
+
+    bool empty() const
+    {
+      return lower[0] > upper[0];
+    }
+
+    bool intersects(const PatchBoundingBox & other) const
+    {
+      if (empty() || other.empty())
+        return false;
+      for (int k = 0; k < dimworld; ++k)
+        if (upper[k] < other.lower[k] || other.upper[k] < lower[k])
+          return false;
+      return true;
+    }
+
+    Dune::FieldVector<ctype,dimworld> lower;
+    Dune::FieldVector<ctype,dimworld> upper;
   };
 
-  template<>
-  struct MPITypeInfo< unsigned int >
+  /** \brief get the MPI communicator of a grid view, MPI_COMM_SELF for sequential grids */
+  template<typename Comm>
+  struct GridViewComm
   {
-    static const unsigned int size = 1;
-    static inline MPI_Datatype getType()
+    static MPI_Comm get(const Comm & c)
     {
-      return MPI_UNSIGNED;
+      return MPI_COMM_SELF;
     }
-    static const int tag = 1234562;
   };
 
   template<>
-  struct MPITypeInfo< Dune::GeometryType >
+  struct GridViewComm< Dune::CollectiveCommunication<MPI_Comm> >
   {
-    static const unsigned int size = 1;
-    static inline MPI_Datatype getType()
+    static MPI_Comm get(const Dune::CollectiveCommunication<MPI_Comm> & c)
     {
-      return Dune::MPITraits< Dune::GeometryType >::getType();
+      return c;
     }
-    static const int tag = 1234563;
   };
 
-  /**
-     Send std::vector<T> in the ring
+#if MPI_VERSION >= 3
+  /** \brief the arrays of a patch, without copying them */
+  template<typename ctype, int dimworld>
+  struct PatchRef
+  {
+    PatchRef(const std::vector<Dune::FieldVector<ctype, dimworld> >& c,
+             const std::vector<unsigned int>& e,
+             const std::vector<Dune::GeometryType>& t)
+      : coords(&c), entities(&e), types(&t)
+    {}
+
+    const std::vector<Dune::FieldVector<ctype, dimworld> >* coords;
+    const std::vector<unsigned int>* entities;
+    const std::vector<Dune::GeometryType>* types;
+  };
 
-   * data is sent to rankright
-   * from rankleft tmp is received and swapped with data
+  /**
+     \brief unpacked patches in an MPI-3 shared memory window, readable by all ranks of a node
 
+     Each rank of the node stores its patches in its own segment of the window:
+     a table with the number of patches and their offsets, then for each patch
+     the number of coordinates, corner indices and entities, followed by the arrays.
+     Creating and destroying the window is collective on the node communicator.
    */
-  template<typename T>
-  void MPI_SendVectorInRing(
-    std::vector<T> & data,
-    std::vector<T> & tmp,
-    int leftsize,
-    int rightrank,
-    int leftrank,
-    MPI_Comm comm
-    )
+  template<typename ctype, int dimworld>
+  class SharedPatches
   {
-    // mpi status stuff
-    int result = 0;
-    MPI_Status status;
-    typedef MPITypeInfo<T> Info;
-    // alloc buffer
-    unsigned int tmpsize = tmp.size();
-    tmp.resize(leftsize);
-    // send data
-    int rank; MPI_Comm_rank(comm, &rank);
-    // std::cout << rank << " send " << data.size() << " to " << rightrank << std::endl;
-    // std::cout << rank << " recv " << tmp.size() << " from " << leftrank << std::endl;
-    if (leftsize > 0 && data.size() > 0)
+  public:
+    typedef Dune::FieldVector<ctype, dimworld> Coords;
+    typedef PatchRef<ctype, dimworld> Patch;
+
+    /** \brief allocate the window and store the patches of this rank in it */
+    SharedPatches(MPI_Comm nodecomm, const std::vector<Patch>& patches)
+    {
+      std::vector<std::size_t> offsets(patches.size()+1, align((1+patches.size())*sizeof(std::size_t)));
+      for (unsigned int k = 0; k < patches.size(); ++k)
+        offsets[k+1] = offsets[k] + align(3*sizeof(std::size_t))
+                       + align(patches[k].coords->size()*sizeof(Coords))
+                       + align(patches[k].entities->size()*sizeof(unsigned int))
+                       + align(patches[k].types->size()*sizeof(Dune::GeometryType));
+
+      char* base = 0;
+      MPI_Win_allocate_shared(offsets.back(), 1, MPI_INFO_NULL, nodecomm, &base, &window_);
+      MPI_Win_fence(0, window_);
+
+      std::size_t* table = reinterpret_cast<std::size_t*>(base);
+      table[0] = patches.size();
+      for (unsigned int k = 0; k < patches.size(); ++k)
+      {
+        table[1+k] = offsets[k];
+        char* data = base + offsets[k];
+        std::size_t* counts = reinterpret_cast<std::size_t*>(data);
+        counts[0] = patches[k].coords->size();
+        counts[1] = patches[k].entities->size();
+        counts[2] = patches[k].types->size();
+        data += align(3*sizeof(std::size_t));
+        copy(*patches[k].coords, data);
+        copy(*patches[k].entities, data);
+        copy(*patches[k].types, data);
+      }
+
+      // the segments are complete
+      MPI_Win_fence(0, window_);
+    }
+
+    ~SharedPatches()
+    {
+      // nobody reads from the window anymore
+      MPI_Win_fence(0, window_);
+      MPI_Win_free(&window_);
+    }
+
+    /** \brief copy the k'th patch stored by the rank noderank of the node */
+    void read(int noderank, unsigned int k,
+              std::vector<Coords>& coords,
+              std::vector<unsigned int>& entities,
+              std::vector<Dune::GeometryType>& types) const
+    {
+      MPI_Aint size;
+      int dispUnit;
+      char* base;
+      MPI_Win_shared_query(window_, noderank, &size, &dispUnit, &base);
+
+      const char* data = base + reinterpret_cast<const std::size_t*>(base)[1+k];
+      const std::size_t* counts = reinterpret_cast<const std::size_t*>(data);
+      data += align(3*sizeof(std::size_t));
+      assign(data, counts[0], coords);
+      assign(data, counts[1], entities);
+      assign(data, counts[2], types);
+    }
+
+  private:
+    SharedPatches(const SharedPatches&);
+    SharedPatches& operator=(const SharedPatches&);
+
+    static std::size_t align(std::size_t bytes)
     {
-      // send & receive
-      result =
-        MPI_Sendrecv(
-          &(data[0]), Info::size*data.size(), Info::getType(), rightrank, Info::tag,
-          &(tmp[0]),  Info::size*tmp.size(),  Info::getType(), leftrank,  Info::tag,
-          comm, &status);
+      return (bytes + 15) & ~std::size_t(15);
     }
-    if (leftsize == 0 && data.size() > 0)
+
+    template<class T>
+    static void copy(const std::vector<T>& values, char*& data)
     {
-      // send
-      result =
-        MPI_Send(
-          &(data[0]), Info::size*data.size(), Info::getType(), rightrank, Info::tag,
-          comm);
+      if (values.size() > 0)
+        std::memcpy(data, &values[0], values.size()*sizeof(T));
+      data += align(values.size()*sizeof(T));
     }
-    if (leftsize > 0 && data.size() == 0)
+
+    template<class T>
+    static void assign(const char*& data, std::size_t n, std::vector<T>& values)
     {
-      // receive
-      result =
-        MPI_Recv(
-          &(tmp[0]),  Info::size*tmp.size(),  Info::getType(), leftrank,  Info::tag,
-          comm, &status);
+      const T* begin = reinterpret_cast<const T*>(data);
+      values.assign(begin, begin + n);
+      data += align(n*sizeof(T));
     }
-    // check result
-    CheckMPIStatus(result, status);
-    // swap buffers
-    data.swap(tmp);
-    // resize tmp buffer
-    tmp.resize(tmpsize);
-
-    MPI_Barrier(comm);
-  }
-
-  /** \brief struct to simplify communication of the patch data sizes */
-  struct PatchSizes
-  {
-    PatchSizes() :
-      patch0coords(0), patch0entities(0), patch0types(0),
-      patch1coords(0), patch1entities(0), patch1types(0) {}
-
-    //! initialize patch sizes
-    PatchSizes(unsigned int c0, unsigned int e0, unsigned int t0,
-               unsigned int c1, unsigned int e1, unsigned int t1) :
-      patch0coords(c0), patch0entities(e0), patch0types(t0),
-      patch1coords(c1), patch1entities(e1), patch1types(t1) {}
-
-    //! initialize patch sizes using the data containers
-    template<typename C, typename E, typename T>
-    PatchSizes(const C & c0, const E &  e0, const T & t0,
-               const C & c1, const E & e1, const T & t1) :
-      patch0coords(c0.size()), patch0entities(e0.size()), patch0types(t0.size()),
-      patch1coords(c1.size()), patch1entities(e1.size()), patch1types(t1.size()) {}
-
-    unsigned int patch0coords, patch0entities, patch0types,
-                 patch1coords, patch1entities, patch1types;
-
-    unsigned int maxCoords() const { return std::max(patch0coords, patch1coords); }
-    unsigned int maxEntities() const { return std::max(patch0entities, patch1entities); }
-    unsigned int maxTypes() const { return std::max(patch0types, patch1types); }
+
+    MPI_Win window_;
   };
+#endif // MPI_VERSION >= 3
+
+  /** \brief MPI_Comm_free a communicator unless it is a predefined one */
+  inline void freeCommunicator(MPI_Comm & comm)
+  {
+    if (comm != MPI_COMM_SELF && comm != MPI_COMM_WORLD && comm != MPI_COMM_NULL)
+      MPI_Comm_free(&comm);
+    comm = MPI_COMM_SELF;
+  }
 }
 #endif // HAVE_MPI
 
 template<typename P0, typename P1>
 GridGlue<P0, P1>::GridGlue(const Grid0Patch& gp0, const Grid1Patch& gp1, Merger* merger) :
-  patch0_(gp0), patch1_(gp1), merger_(merger)
+  patch0_(gp0), patch1_(gp1), merger_(merger), index__sz(0), buildRevision_(0),
+  ordering_(MergerOrdering), boundingBoxTolerance_(-1),
+  nodeSharedPatches_(false), nPreviousIntersections_(0)
 {
 #if HAVE_MPI
   // if we have only seq. meshes don't use parallel glueing
-  if (gp0.gridView().comm().size() == 1
-      && gp1.gridView().comm().size() == 1)
-    mpicomm_ = MPI_COMM_SELF;
+  typedef typename Grid0Patch::GridView::CollectiveCommunication Comm0;
+  typedef typename Grid1Patch::GridView::CollectiveCommunication Comm1;
+  const MPI_Comm comm0 = GridViewComm<Comm0>::get(gp0.gridView().comm());
+  const MPI_Comm comm1 = GridViewComm<Comm1>::get(gp1.gridView().comm());
+  if (gp0.gridView().comm().size() > 1)
+  {
+    parentcomm_ = comm0;
+    int result = MPI_UNEQUAL;
+    if (gp1.gridView().comm().size() > 1)
+      MPI_Comm_compare(comm0, comm1, &result);
+    if (gp1.gridView().comm().size() > 1 && result == MPI_UNEQUAL)
+      DUNE_THROW(Dune::NotImplemented, "GridGlue for grids distributed over different groups of processes");
+  }
+  else if (gp1.gridView().comm().size() > 1)
+    parentcomm_ = comm1;
   else
-    mpicomm_ = MPI_COMM_WORLD;
+    parentcomm_ = MPI_COMM_SELF;
+  mpicomm_ = MPI_COMM_SELF;
+  nodecomm_ = MPI_COMM_SELF;
 #endif // HAVE_MPI
   std::cout << "GridGlue: Constructor succeeded!" << std::endl;
 }
 
+template<typename P0, typename P1>
+GridGlue<P0, P1>::~GridGlue()
+{
+#if HAVE_MPI
+  freeCommunicator(nodecomm_);
+  freeCommunicator(mpicomm_);
+#endif // HAVE_MPI
+}
+
 template<typename P0, typename P1>
 void GridGlue<P0, P1>::build()
 {
-  int myrank = 0;
+  ++buildRevision_;
+
 #if HAVE_MPI
-  int commsize = 1;
-  MPI_Comm_rank(mpicomm_, &myrank);
-  MPI_Comm_size(mpicomm_, &commsize);
+  // the communication interfaces refer to the old intersections
+  communicators_.clear();
+  interfaces_.clear();
 #endif // HAVE_MPI
 
   // clear the contents from the current intersections array
@@ -185,22 +356,50 @@ void GridGlue<P0, P1>::build()
     std::vector<IntersectionData> dummy;
     intersections_.swap(dummy);
   }
+  nPreviousIntersections_ = index__sz;
+  index__sz = 0;
 
   std::vector<Dune::FieldVector<ctype, dimworld> > patch0coords;
-  std::vector<unsigned int> patch0entities;
-  std::vector<Dune::GeometryType> patch0types;
+  const std::vector<unsigned int>& patch0entities = patch0topology_.entities;
+  const std::vector<Dune::GeometryType>& patch0types = patch0topology_.types;
   std::vector<Dune::FieldVector<ctype,dimworld> > patch1coords;
-  std::vector<unsigned int> patch1entities;
-  std::vector<Dune::GeometryType> patch1types;
+  const std::vector<unsigned int>& patch1entities = patch1topology_.entities;
+  const std::vector<Dune::GeometryType>& patch1types = patch1topology_.types;
 
   /*
    * extract global surface patchs
    */
 
   // retrieve the coordinate and topology information from the extractors
-  // and apply transformations if necessary
-  extractGrid(patch0_, patch0coords, patch0entities, patch0types);
-  extractGrid(patch1_, patch1coords, patch1entities, patch1types);
+  // and apply transformations if necessary, the topology only if it has changed
+  extractGrid(patch0_, patch0coords, patch0topology_);
+  extractGrid(patch1_, patch1coords, patch1topology_);
+
+  int myrank = 0;
+#if HAVE_MPI
+  // Only the ranks with a non-empty patch take part in the parallel build.
+  // The others get no intersections and leave after splitting the communicator.
+  freeCommunicator(nodecomm_);
+  freeCommunicator(mpicomm_);
+  if (parentcomm_ != MPI_COMM_SELF)
+  {
+    const bool hasPatch = (patch0types.size() > 0 || patch1types.size() > 0);
+    int parentrank = 0;
+    MPI_Comm_rank(parentcomm_, &parentrank);
+    MPI_Comm_split(parentcomm_, hasPatch ? 0 : MPI_UNDEFINED, parentrank, &mpicomm_);
+
+    // a single rank with patches needs no communication
+    int subcommsize = 0;
+    if (mpicomm_ != MPI_COMM_NULL)
+      MPI_Comm_size(mpicomm_, &subcommsize);
+    if (subcommsize <= 1)
+      freeCommunicator(mpicomm_);
+  }
+
+  int commsize = 1;
+  MPI_Comm_rank(mpicomm_, &myrank);
+  MPI_Comm_size(mpicomm_, &commsize);
+#endif // HAVE_MPI
 
   std::cout << ">>>> rank " << myrank << " coords: "
             << patch0coords.size() << " and " << patch1coords.size() << std::endl;
@@ -251,122 +450,119 @@ void GridGlue<P0, P1>::build()
 
   // status variables of communication
   int mpi_result;
-  MPI_Status mpi_status;
 
   if (commsize > 1)
   {
-    // get patch sizes
-    PatchSizes patchSizes (patch0coords, patch0entities, patch0types,
-                           patch1coords, patch1entities, patch1types);
-
-    // communicate max patch size
-    PatchSizes maxPatchSizes;
-    mpi_result = MPI_Allreduce(&patchSizes, &maxPatchSizes,
-                               6, MPI_UNSIGNED, MPI_MAX, MPI_COMM_WORLD);
+    // pack our patches
+    typedef Dune::GridGlue::PatchMessage<ctype, dimworld> Message;
+    std::vector<char> messages[2];
+    Message::pack(patch0coords, patch0entities, patch0types, messages[0]);
+    Message::pack(patch1coords, patch1entities, patch1types, messages[1]);
+
+    // get the message sizes of all ranks
+    unsigned int messageSizes[2] = { (unsigned int) messages[0].size(), (unsigned int) messages[1].size() };
+    std::vector<unsigned int> allMessageSizes(2*commsize);
+    mpi_result = MPI_Allgather(messageSizes, 2, MPI_UNSIGNED,
+                               &(allMessageSizes[0]), 2, MPI_UNSIGNED, mpicomm_);
     CheckMPIStatus(mpi_result, 0);
 
-    /**
-       \todo Use vector<struct> for message buffer and MultiVector to copy these
-     */
-    // allocate remote buffers (maxsize to avoid reallocation)
-    std::vector<Dune::FieldVector<ctype, dimworld> > remotePatch0coords ( maxPatchSizes.patch0coords );
-    std::vector<unsigned int> remotePatch0entities ( maxPatchSizes.patch0entities );
-    std::vector<Dune::GeometryType> remotePatch0types ( maxPatchSizes.patch0types );
-    std::vector<Dune::FieldVector<ctype,dimworld> > remotePatch1coords ( maxPatchSizes.patch1coords );
-    std::vector<unsigned int> remotePatch1entities ( maxPatchSizes.patch1entities );
-    std::vector<Dune::GeometryType> remotePatch1types ( maxPatchSizes.patch1types );
-
-    // copy local patches to remote patch buffers
-    remotePatch0coords.clear();
-    std::copy(patch0coords.begin(), patch0coords.end(), std::back_inserter(remotePatch0coords));
-    remotePatch0entities.clear();
-    std::copy(patch0entities.begin(), patch0entities.end(), std::back_inserter(remotePatch0entities));
-    remotePatch0types.clear();
-    std::copy(patch0types.begin(), patch0types.end(), std::back_inserter(remotePatch0types));
-
-    remotePatch1coords.clear();
-    std::copy(patch1coords.begin(), patch1coords.end(), std::back_inserter(remotePatch1coords));
-    remotePatch1entities.clear();
-    std::copy(patch1entities.begin(), patch1entities.end(), std::back_inserter(remotePatch1entities));
-    remotePatch1types.clear();
-    std::copy(patch1types.begin(), patch1types.end(), std::back_inserter(remotePatch1types));
-
-    // allocate tmp buffers (maxsize to avoid reallocation)
-    std::vector<Dune::FieldVector<ctype, dimworld> > tmpPatchCoords ( maxPatchSizes.maxCoords() );
-    std::vector<unsigned int> tmpPatchEntities ( maxPatchSizes.maxEntities() );
-    std::vector<Dune::GeometryType> tmpPatchTypes ( maxPatchSizes.maxTypes() );
-
-    // communicate patches in the ring
-    for (int i=1; i<commsize; i++)
+    // get the bounding boxes of all patches
+    typedef PatchBoundingBox<ctype, dimworld> BoundingBox;
+    std::vector<BoundingBox> boxes(2*commsize);
+    {
+      BoundingBox localBoxes[2] = {
+        BoundingBox(patch0coords, boundingBoxTolerance_),
+        BoundingBox(patch1coords, boundingBoxTolerance_)
+      };
+      mpi_result = MPI_Allgather(localBoxes, 4*dimworld, Dune::MPITraits<ctype>::getType(),
+                                 &(boxes[0]), 4*dimworld, Dune::MPITraits<ctype>::getType(), mpicomm_);
+      CheckMPIStatus(mpi_result, 0);
+    }
+
+    // Only ranks with overlapping patches exchange data:
+    // we merge our patch0 with the patch1 of rank r if their boxes overlap, and r does the same.
+    std::vector<bool> exchange01(commsize, false);
+    std::vector<bool> exchange10(commsize, false);
+    for (int r = 0; r < commsize; ++r)
+    {
+      if (r == myrank)
+        continue;
+      exchange01[r] = boxes[2*myrank].intersects(boxes[2*r+1]);
+      exchange10[r] = boxes[2*myrank+1].intersects(boxes[2*r]);
+    }
+
+#if MPI_VERSION >= 3
+    if (nodeSharedPatches_)
     {
-      int remoterank = (myrank - i + commsize) % commsize;
-      int rightrank  = (myrank + 1 + commsize) % commsize;
-      int leftrank   = (myrank - 1 + commsize) % commsize;
+      // the patches of the other ranks we merge with, see exchange01 and exchange10
+      std::vector<char> needs(2*commsize, false);
+      for (int r = 0; r < commsize; ++r)
+      {
+        needs[2*r + 0] = exchange10[r];
+        needs[2*r + 1] = exchange01[r];
+      }
+
+      mergeNodeSharedPatches(messages, allMessageSizes, needs,
+                             patch0coords, patch0entities, patch0types,
+                             patch1coords, patch1entities, patch1types);
+    }
+    else
+#endif // MPI_VERSION >= 3
+    {
+      // send our patches to the ranks that need them
+      std::vector<MPI_Request> requests;
+      for (int r = 0; r < commsize; ++r)
+      {
+        if (exchange01[r])
+          MPI_ISendPatch(messages[0], 0, r, mpicomm_, requests);
+        if (exchange10[r])
+          MPI_ISendPatch(messages[1], 1, r, mpicomm_, requests);
+      }
 
-      // communicate current patch sizes
-      // patchsizes were initialized before
+      // the remote patches to receive, as pairs (rank, patch number)
+      std::vector<std::pair<int,int> > incoming;
+      for (int r = 0; r < commsize; ++r)
       {
-        // send to right neighbor, receive from left neighbor
-        mpi_result =
-          MPI_Sendrecv_replace(
-            &patchSizes, 6, MPI_UNSIGNED,
-            rightrank, MPITypeInfo<unsigned int>::tag,
-            leftrank,  MPITypeInfo<unsigned int>::tag,
-            mpicomm_, &mpi_status);
-        CheckMPIStatus(mpi_result, mpi_status);
+        if (exchange01[r])
+          incoming.push_back(std::make_pair(r, 1));
+        if (exchange10[r])
+          incoming.push_back(std::make_pair(r, 0));
       }
 
-      /* send remote patch to right neighbor and receive from left neighbor */
-
-      // patch0coords
-      // std::cout << myrank << " patch0coords" << std::endl;
-      MPI_SendVectorInRing(
-        remotePatch0coords, tmpPatchCoords, patchSizes.patch0coords,
-        rightrank, leftrank, mpicomm_);
-
-      // patch0entities
-      // std::cout << myrank << " patch0entities" << std::endl;
-      MPI_SendVectorInRing(
-        remotePatch0entities, tmpPatchEntities, patchSizes.patch0entities,
-        rightrank, leftrank, mpicomm_);
-
-      // patch0types
-      // std::cout << myrank << " patch0types" << std::endl;
-      MPI_SendVectorInRing(
-        remotePatch0types, tmpPatchTypes, patchSizes.patch0types,
-        rightrank, leftrank, mpicomm_);
-
-      // patch1coords
-      // std::cout << myrank << " patch1coords" << std::endl;
-      MPI_SendVectorInRing(
-        remotePatch1coords, tmpPatchCoords, patchSizes.patch1coords,
-        rightrank, leftrank, mpicomm_);
-
-      // patch1entities
-      // std::cout << myrank << " patch1entities" << std::endl;
-      MPI_SendVectorInRing(
-        remotePatch1entities, tmpPatchEntities, patchSizes.patch1entities,
-        rightrank, leftrank, mpicomm_);
-
-      // patch1types
-      // std::cout << myrank << " patch1types" << std::endl;
-      MPI_SendVectorInRing(
-        remotePatch1types, tmpPatchTypes, patchSizes.patch1types,
-        rightrank, leftrank, mpicomm_);
-
-      /* merging */
-      // merge local & remote patches
+      // receive the remote patches and merge them with the local ones
       // domain_is_ and target__is are updated automatically
-      if (remotePatch1entities.size() > 0 && patch0entities.size() > 0)
-        mergePatches(patch0coords, patch0entities, patch0types, myrank,
-                     remotePatch1coords, remotePatch1entities, remotePatch1types, remoterank);
-      if (remotePatch0entities.size() > 0 && patch1entities.size() > 0)
-        mergePatches(remotePatch0coords, remotePatch0entities, remotePatch0types, remoterank,
-                     patch1coords, patch1entities, patch1types, myrank);
+      // Two buffers are used alternately: the next patch is received while the
+      // current one is merged.
+      RemotePatch<ctype, dimworld> buffers[2];
+      if (incoming.size() > 0)
+        buffers[0].receive(allMessageSizes[2*incoming[0].first + incoming[0].second],
+                           incoming[0].second, incoming[0].first, mpicomm_);
+
+      for (unsigned int k = 0; k < incoming.size(); ++k)
+      {
+        if (k+1 < incoming.size())
+          buffers[(k+1)%2].receive(allMessageSizes[2*incoming[k+1].first + incoming[k+1].second],
+                                   incoming[k+1].second, incoming[k+1].first, mpicomm_);
+
+        RemotePatch<ctype, dimworld> & remote = buffers[k%2];
+        remote.wait();
+
+        const int r = incoming[k].first;
+        if (incoming[k].second == 1)
+          mergePatches(patch0coords, patch0entities, patch0types, myrank,
+                       remote.coords, remote.entities, remote.types, r);
+        else
+          mergePatches(remote.coords, remote.entities, remote.types, r,
+                       patch1coords, patch1entities, patch1types, myrank);
+      }
 
-      std::cout << "Sync processes" << std::endl;
-      MPI_Barrier(mpicomm_);
-      std::cout << "...done" << std::endl;
+      // wait until our patches have been delivered
+      if (requests.size() > 0)
+      {
+        std::vector<MPI_Status> statuses(requests.size());
+        mpi_result = MPI_Waitall(requests.size(), &(requests[0]), &(statuses[0]));
+        CheckMPIStatus(mpi_result, 0);
+      }
     }
   }
 
@@ -375,7 +571,18 @@ void GridGlue<P0, P1>::build()
     // finalize ParallelIndexSet & RemoteIndices
     domain_is_.endResize();
     target_is_.endResize();
+  }
+#endif
 
+  // none of the intersections is kept
+  previousIntersectionIndex_.assign(index__sz, -1);
+
+  reorderIntersections();
+  resetOwnership();
+
+#if HAVE_MPI
+  if (commsize > 1)
+  {
     // setup remote index information
     remoteIndices_.setIncludeSelf(false);
     remoteIndices_.setIndexSets(domain_is_, target_is_, mpicomm_) ;
@@ -385,6 +592,569 @@ void GridGlue<P0, P1>::build()
 
 }
 
+#if HAVE_MPI && MPI_VERSION >= 3
+template<typename P0, typename P1>
+void GridGlue<P0, P1>::mergeNodeSharedPatches(
+  const std::vector<char> messages[2],
+  const std::vector<unsigned int>& allMessageSizes,
+  const std::vector<char>& needs,
+  const std::vector<Dune::FieldVector<ctype,dimworld> >& patch0coords,
+  const std::vector<unsigned int>& patch0entities,
+  const std::vector<Dune::GeometryType>& patch0types,
+  const std::vector<Dune::FieldVector<ctype,dimworld> >& patch1coords,
+  const std::vector<unsigned int>& patch1entities,
+  const std::vector<Dune::GeometryType>& patch1types)
+{
+  typedef SharedPatches<ctype, dimworld> Shared;
+  typedef typename Shared::Patch Patch;
+
+  int myrank = 0;
+  int commsize = 1;
+  MPI_Comm_rank(mpicomm_, &myrank);
+  MPI_Comm_size(mpicomm_, &commsize);
+
+  // the ranks sharing memory with this one, kept until mpicomm_ is split again
+  if (nodecomm_ == MPI_COMM_SELF)
+    MPI_Comm_split_type(mpicomm_, MPI_COMM_TYPE_SHARED, myrank, MPI_INFO_NULL, &nodecomm_);
+  int noderank = 0;
+  int nodesize = 1;
+  MPI_Comm_rank(nodecomm_, &noderank);
+  MPI_Comm_size(nodecomm_, &nodesize);
+
+  std::vector<int> nodeRanks(nodesize);
+  MPI_Allgather(&myrank, 1, MPI_INT, &(nodeRanks[0]), 1, MPI_INT, nodecomm_);
+  std::map<int, int> nodeIndex;
+  for (int k = 0; k < nodesize; ++k)
+    nodeIndex[nodeRanks[k]] = k;
+
+  // the first rank of each node receives the remote patches for the node
+  int leader = nodeRanks[0];
+  std::vector<int> leaders(commsize);
+  MPI_Allgather(&leader, 1, MPI_INT, &(leaders[0]), 1, MPI_INT, mpicomm_);
+
+  // which patches the ranks of this node merge with, only their rows of the pattern are needed
+  std::vector<char> nodeNeeds(2*commsize*nodesize);
+  MPI_Allgather(const_cast<char*>(&(needs[0])), 2*commsize, MPI_CHAR,
+                &(nodeNeeds[0]), 2*commsize, MPI_CHAR, nodecomm_);
+
+  // send our patches once to each other node that needs them; the boxes are compared
+  // symmetrically, so rank q merges with our patch p if we merge with its patch 1-p
+  std::vector<MPI_Request> requests;
+  for (int p = 0; p < 2; ++p)
+  {
+    std::vector<bool> sent(commsize, false);
+    for (int q = 0; q < commsize; ++q)
+      if (leaders[q] != leader && needs[2*q + 1-p] && !sent[leaders[q]])
+      {
+        MPI_ISendPatch(messages[p], p, leaders[q], mpicomm_, requests);
+        sent[leaders[q]] = true;
+      }
+  }
+
+  // the patches we merge with, in the same order as the point-to-point exchange
+  std::vector<std::pair<int,int> > merges;
+  for (int r = 0; r < commsize; ++r)
+    for (int p = 1; p >= 0; --p)
+      if (r != myrank && needs[2*r+p])
+        merges.push_back(std::make_pair(r,p));
+
+  // the patches of other nodes needed on this node, in the same order
+  std::vector<std::pair<int,int> > incoming;
+  std::map<std::pair<int,int>, unsigned int> incomingIndex;
+  std::size_t largest = 0;
+  for (int r = 0; r < commsize; ++r)
+  {
+    if (leaders[r] == leader)
+      continue;
+    for (int p = 1; p >= 0; --p)
+      for (int k = 0; k < nodesize; ++k)
+        if (nodeNeeds[2*(k*commsize + r) + p])
+        {
+          incomingIndex[std::make_pair(r,p)] = incoming.size();
+          incoming.push_back(std::make_pair(r,p));
+          largest = std::max(largest, std::size_t(allMessageSizes[2*r+p]));
+          break;
+        }
+  }
+
+  // The remote patches are received in rounds of about one patch per rank of the
+  // node, so the node does not hold all of them at once.  All ranks of the node
+  // compute the same rounds.
+  std::vector<unsigned int> roundStart(1, 0);
+  std::size_t roundSize = 0;
+  for (unsigned int k = 0; k < incoming.size(); ++k)
+  {
+    const std::size_t size = allMessageSizes[2*incoming[k].first + incoming[k].second];
+    if (roundSize > 0 && roundSize + size > nodesize*largest)
+    {
+      roundStart.push_back(k);
+      roundSize = 0;
+    }
+    roundSize += size;
+  }
+  if (incoming.size() > 0)
+    roundStart.push_back(incoming.size());
+
+  // the own patches of every rank of the node, read by the others instead of a message
+  std::vector<Patch> own;
+  own.push_back(Patch(patch0coords, patch0entities, patch0types));
+  own.push_back(Patch(patch1coords, patch1entities, patch1types));
+  const Shared ownPatches(nodecomm_, own);
+
+  std::vector<Dune::FieldVector<ctype, dimworld> > remoteCoords;
+  std::vector<unsigned int> remoteEntities;
+  std::vector<Dune::GeometryType> remoteTypes;
+
+  // after the last round only the patches of this node are left to merge
+  const unsigned int nRounds = roundStart.size() - 1;
+  unsigned int next = 0;
+  for (unsigned int round = 0; round <= nRounds; ++round)
+  {
+    const unsigned int begin = roundStart[std::min(round, nRounds)];
+    const unsigned int end = (round < nRounds) ? roundStart[round+1] : incoming.size();
+
+    // the leader receives and unpacks the patches of the round, once for the node
+    std::vector<RemotePatch<ctype, dimworld> > buffers((noderank == 0) ? end - begin : 0);
+    std::vector<Patch> received;
+    for (unsigned int k = 0; k < buffers.size(); ++k)
+      buffers[k].receive(allMessageSizes[2*incoming[begin+k].first + incoming[begin+k].second],
+                         incoming[begin+k].second, incoming[begin+k].first, mpicomm_);
+    for (unsigned int k = 0; k < buffers.size(); ++k)
+    {
+      buffers[k].wait();
+      received.push_back(Patch(buffers[k].coords, buffers[k].entities, buffers[k].types));
+    }
+    const Shared remotePatches(nodecomm_, received);
+
+    // merge with the patches up to the last one of this round
+    for (; next < merges.size(); ++next)
+    {
+      const int r = merges[next].first;
+      const int p = merges[next].second;
+      const std::vector<Dune::FieldVector<ctype, dimworld> >* coords = &remoteCoords;
+      const std::vector<unsigned int>* entities = &remoteEntities;
+      const std::vector<Dune::GeometryType>* types = &remoteTypes;
+
+      if (leaders[r] == leader)
+        ownPatches.read(nodeIndex[r], p, remoteCoords, remoteEntities, remoteTypes);
+      else
+      {
+        const unsigned int k = incomingIndex[merges[next]];
+        if (k >= end)
+          break;
+        if (noderank == 0)
+        {
+          coords = &buffers[k-begin].coords;
+          entities = &buffers[k-begin].entities;
+          types = &buffers[k-begin].types;
+        }
+        else
+          remotePatches.read(0, k-begin, remoteCoords, remoteEntities, remoteTypes);
+      }
+
+      if (p == 1)
+        mergePatches(patch0coords, patch0entities, patch0types, myrank,
+                     *coords, *entities, *types, r);
+      else
+        mergePatches(*coords, *entities, *types, r,
+                     patch1coords, patch1entities, patch1types, myrank);
+    }
+  }
+
+  // wait until our patches have been delivered
+  if (requests.size() > 0)
+  {
+    std::vector<MPI_Status> statuses(requests.size());
+    MPI_Waitall(requests.size(), &(requests[0]), &(statuses[0]));
+  }
+}
+#endif // HAVE_MPI && MPI_VERSION >= 3
+
+template<typename P0, typename P1>
+template<class T>
+const char GridGlue<P0, P1>::TypeKey<T>::id = 0;
+
+#if HAVE_MPI
+template<typename P0, typename P1>
+const Dune::Interface & GridGlue<P0, P1>::communicationInterface(Dune::InterfaceType iftype,
+                                                                 Dune::CommunicationDirection dir) const
+{
+  shared_ptr<Dune::Interface> & interface = interfaces_[std::make_pair(int(iftype), int(dir))];
+  if (interface)
+    return *interface;
+
+  // setup communication interfaces
+  typedef Dune::EnumItem <Dune::PartitionType, Dune::InteriorEntity> InteriorFlags;
+  typedef Dune::EnumItem <Dune::PartitionType, Dune::OverlapEntity>  OverlapFlags;
+  typedef Dune::EnumRange <Dune::PartitionType, Dune::InteriorEntity, Dune::GhostEntity>  AllFlags;
+  interface = shared_ptr<Dune::Interface>(new Dune::Interface);
+  switch (iftype)
+  {
+  case Dune::InteriorBorder_InteriorBorder_Interface :
+    interface->build (remoteIndices_, InteriorFlags(), InteriorFlags() );
+    break;
+  case Dune::InteriorBorder_All_Interface :
+    if (dir == Dune::ForwardCommunication)
+      interface->build (remoteIndices_, InteriorFlags(), AllFlags() );
+    else
+      interface->build (remoteIndices_, AllFlags(), InteriorFlags() );
+    break;
+  case Dune::Overlap_OverlapFront_Interface :
+    interface->build (remoteIndices_, OverlapFlags(), OverlapFlags() );
+    break;
+  case Dune::Overlap_All_Interface :
+    if (dir == Dune::ForwardCommunication)
+      interface->build (remoteIndices_, OverlapFlags(), AllFlags() );
+    else
+      interface->build (remoteIndices_, AllFlags(), OverlapFlags() );
+    break;
+  case Dune::All_All_Interface :
+    interface->build (remoteIndices_, AllFlags(), AllFlags() );
+    break;
+  default :
+    interfaces_.erase(std::make_pair(int(iftype), int(dir)));
+    DUNE_THROW(Dune::NotImplemented, "GridGlue::communicate for interface " << iftype << " not implemented");
+  }
+  return *interface;
+}
+#endif // HAVE_MPI
+
+template<typename P0, typename P1>
+void GridGlue<P0, P1>::buildIncremental()
+{
+#if HAVE_MPI
+  // the remote index sets would have to be rebuilt, too,
+  // and all ranks of parentcomm_ have to take part in the build
+  if (parentcomm_ != MPI_COMM_SELF)
+  {
+    build();
+    return;
+  }
+#endif // HAVE_MPI
+
+  // the subentities of the last build in the current patches, if they are known
+  std::vector<int> patch0old2new;
+  std::vector<int> patch1old2new;
+  std::vector<bool> patch0changed;
+  std::vector<bool> patch1changed;
+  if (!merger_->supportsIncrementalBuild() || index__sz == 0
+      || !subEntityMapping(patch0_, patch0topology_, patch0old2new, patch0changed)
+      || !subEntityMapping(patch1_, patch1topology_, patch1old2new, patch1changed))
+  {
+    build();
+    return;
+  }
+
+  // keep the intersections between unchanged subentities and renumber them
+  std::vector<std::pair<unsigned int, unsigned int> > knownPairs;
+  std::vector<int> previousIndex;
+  unsigned int nKept = 0;
+
+  for (unsigned int i = 0; i < index__sz; ++i)
+  {
+    IntersectionData & data = intersections_[i];
+    assert(data.grid0index_ < patch0old2new.size() && data.grid1index_ < patch1old2new.size());
+
+    const int newIndex0 = patch0old2new[data.grid0index_];
+    const int newIndex1 = patch1old2new[data.grid1index_];
+    if (newIndex0 < 0 || newIndex1 < 0)
+      continue;
+
+    data.grid0index_ = newIndex0;
+    data.grid1index_ = newIndex1;
+    data.index_ = nKept;
+    knownPairs.push_back(std::make_pair(newIndex0, newIndex1));
+    previousIndex.push_back(i);
+
+    if (nKept != i)
+      intersections_[nKept] = data;
+    ++nKept;
+  }
+
+  // nothing left to reuse
+  if (nKept == 0)
+  {
+    build();
+    return;
+  }
+
+  std::sort(knownPairs.begin(), knownPairs.end());
+  knownPairs.erase(std::unique(knownPairs.begin(), knownPairs.end()), knownPairs.end());
+
+  std::vector<Dune::FieldVector<ctype, dimworld> > patch0coords;
+  const std::vector<unsigned int>& patch0entities = patch0topology_.entities;
+  const std::vector<Dune::GeometryType>& patch0types = patch0topology_.types;
+  std::vector<Dune::FieldVector<ctype,dimworld> > patch1coords;
+  const std::vector<unsigned int>& patch1entities = patch1topology_.entities;
+  const std::vector<Dune::GeometryType>& patch1types = patch1topology_.types;
+
+  extractGrid(patch0_, patch0coords, patch0topology_);
+  extractGrid(patch1_, patch1coords, patch1topology_);
+  assert(patch0changed.size() == patch0types.size() && patch1changed.size() == patch1types.size());
+
+  // compute the missing intersections
+  merger_->buildIncremental(patch0coords, patch0entities, patch0types, patch0changed,
+                            patch1coords, patch1entities, patch1types, patch1changed,
+                            knownPairs);
+
+  // append them to the kept ones, followed by the end marker
+  intersections_.resize(nKept);
+  intersections_.resize(nKept + merger_->nSimplices() + 1);
+  for (unsigned int i = 0; i < merger_->nSimplices(); ++i)
+    intersections_[nKept+i] = IntersectionData(*this, i, nKept, true, true);
+
+  nPreviousIntersections_ = index__sz;
+  index__sz = intersections_.size() - 1;
+  ++buildRevision_;
+
+  // the kept intersections come first, the new ones have no previous index
+  previousIntersectionIndex_.swap(previousIndex);
+  previousIntersectionIndex_.resize(index__sz, -1);
+
+  reorderIntersections();
+  resetOwnership();
+
+  // cleanup the merger
+  merger_->clear();
+}
+
+template<typename P0, typename P1>
+void GridGlue<P0, P1>::resetOwnership()
+{
+  owned_.resize(index__sz);
+  for (unsigned int i = 0; i < index__sz; ++i)
+    owned_[i] = intersections_[i].grid0local_;
+}
+
+template<typename P0, typename P1>
+template<class Weight>
+double GridGlue<P0, P1>::rebalanceOwnership(const Weight& weight)
+{
+  resetOwnership();
+
+#if HAVE_MPI
+  if (mpicomm_ == MPI_COMM_SELF)
+    return 1.0;
+
+  int myrank = 0;
+  int commsize = 1;
+  MPI_Comm_rank(mpicomm_, &myrank);
+  MPI_Comm_size(mpicomm_, &commsize);
+
+  typedef Dune::GridGlue::RankPair RankPair;
+  typedef typename PIndexSet::const_iterator IndexIterator;
+
+  // The weight of the intersections with a local domain entity:
+  // the ones with a local target entity, too, always stay on this rank,
+  // the others are shared with the rank of the target entity.
+  double fixedLoad = 0;
+  std::map<RankPair, double> pairWeights;
+  std::map<RankPair, std::vector<std::pair<unsigned int, double> > > sharedWeights;
+  for (IndexIterator it = domain_is_.begin(); it != domain_is_.end(); ++it)
+  {
+    const GlobalId & gid = it->global();
+    const double w = weight(this->template getIntersection<0>(it->local().local()));
+    if (gid.first.second == myrank)
+      fixedLoad += w;
+    else
+    {
+      pairWeights[gid.first] += w;
+      sharedWeights[gid.first].push_back(std::make_pair(gid.second, w));
+    }
+  }
+
+  // gather the loads and the shared weights of all ranks
+  std::vector<double> loads(commsize);
+  MPI_Allgather(&fixedLoad, 1, MPI_DOUBLE, &(loads[0]), 1, MPI_DOUBLE, mpicomm_);
+
+  // the rank pairs and their weights, in separate arrays of matching MPI types
+  std::vector<int> localRanks;
+  std::vector<double> localWeights;
+  for (typename std::map<RankPair, double>::const_iterator it = pairWeights.begin(); it != pairWeights.end(); ++it)
+  {
+    localRanks.push_back(it->first.first);
+    localRanks.push_back(it->first.second);
+    localWeights.push_back(it->second);
+  }
+  int nLocalPairs = localWeights.size();
+  std::vector<int> nPairs(commsize);
+  MPI_Allgather(&nLocalPairs, 1, MPI_INT, &(nPairs[0]), 1, MPI_INT, mpicomm_);
+
+  std::vector<int> pairsOffsets(commsize+1, 0);
+  std::vector<int> rankCounts(commsize);
+  std::vector<int> rankOffsets(commsize);
+  for (int r = 0; r < commsize; ++r)
+  {
+    pairsOffsets[r+1] = pairsOffsets[r] + nPairs[r];
+    rankCounts[r] = 2*nPairs[r];
+    rankOffsets[r] = 2*pairsOffsets[r];
+  }
+  const int nAllPairs = pairsOffsets[commsize];
+
+  std::vector<int> allRanks(std::max(2*nAllPairs, 1));
+  std::vector<double> allWeights(std::max(nAllPairs, 1));
+  MPI_Allgatherv(nLocalPairs ? &(localRanks[0]) : 0, 2*nLocalPairs, MPI_INT,
+                 &(allRanks[0]), &(rankCounts[0]), &(rankOffsets[0]), MPI_INT, mpicomm_);
+  MPI_Allgatherv(nLocalPairs ? &(localWeights[0]) : 0, nLocalPairs, MPI_DOUBLE,
+                 &(allWeights[0]), &(nPairs[0]), &(pairsOffsets[0]), MPI_DOUBLE, mpicomm_);
+
+  // the shared weights, the heaviest first
+  std::vector<std::pair<double, RankPair> > pairs;
+  for (int k = 0; k < nAllPairs; ++k)
+    pairs.push_back(std::make_pair(-allWeights[k], RankPair(allRanks[2*k], allRanks[2*k+1])));
+  std::sort(pairs.begin(), pairs.end());
+
+  // Give each pair to its two ranks such that their loads become as equal as possible.
+  // All ranks do this with the same data, so they agree on the result.
+  std::map<RankPair, double> domainShare;
+  for (unsigned int k = 0; k < pairs.size(); ++k)
+  {
+    const double w = -pairs[k].first;
+    const int a = pairs[k].second.first;
+    const int b = pairs[k].second.second;
+    const double toA = std::max(0.0, std::min(w, 0.5*(loads[b] + w - loads[a])));
+    loads[a] += toA;
+    loads[b] += w - toA;
+    domainShare[pairs[k].second] = toA;
+  }
+
+  // The domain rank of a pair owns its intersections with a global id below the split.
+  // It places the split in the order of the ids where the cumulative weight comes
+  // closest to its share, and sums up the weight that each rank actually owns.
+  std::vector<int> localSplits;
+  std::vector<double> ownedLoads(commsize, 0.0);
+  ownedLoads[myrank] = fixedLoad;
+  for (typename std::map<RankPair, double>::const_iterator it = pairWeights.begin(); it != pairWeights.end(); ++it)
+  {
+    std::vector<std::pair<unsigned int, double> > & shared = sharedWeights[it->first];
+    std::sort(shared.begin(), shared.end());
+    const double share = domainShare[it->first];
+
+    double sum = 0;
+    std::size_t k = 0;
+    for (; k < shared.size(); ++k)
+    {
+      const double next = sum + shared[k].second;
+      if (next - share > share - sum)
+        break;
+      sum = next;
+    }
+
+    localSplits.push_back(k < shared.size() ? int(shared[k].first) : int(shared.back().first) + 1);
+    ownedLoads[it->first.first] += sum;
+    ownedLoads[it->first.second] += it->second - sum;
+  }
+
+  // tell the target ranks where the pairs are split
+  std::vector<int> allSplits(std::max(nAllPairs, 1));
+  MPI_Allgatherv(nLocalPairs ? &(localSplits[0]) : 0, nLocalPairs, MPI_INT,
+                 &(allSplits[0]), &(nPairs[0]), &(pairsOffsets[0]), MPI_INT, mpicomm_);
+  std::map<RankPair, unsigned int> splits;
+  for (int k = 0; k < nAllPairs; ++k)
+    splits[RankPair(allRanks[2*k], allRanks[2*k+1])] = allSplits[k];
+
+  for (IndexIterator it = domain_is_.begin(); it != domain_is_.end(); ++it)
+  {
+    const GlobalId & gid = it->global();
+    if (gid.first.second == myrank)
+      continue;
+    owned_[it->local().local()] = (gid.second < splits[gid.first]);
+  }
+  for (IndexIterator it = target_is_.begin(); it != target_is_.end(); ++it)
+  {
+    const GlobalId & gid = it->global();
+    if (gid.first.first == myrank)
+      continue;
+    owned_[it->local().local()] = (gid.second >= splits[gid.first]);
+  }
+
+  // report the load imbalance of the resulting ownership
+  std::vector<double> owned(commsize);
+  MPI_Allreduce(&(ownedLoads[0]), &(owned[0]), commsize, MPI_DOUBLE, MPI_SUM, mpicomm_);
+  const double total = std::accumulate(owned.begin(), owned.end(), 0.0);
+  if (total <= 0)
+    return 1.0;
+  return *std::max_element(owned.begin(), owned.end()) * commsize / total;
+#else
+  return 1.0;
+#endif // HAVE_MPI
+}
+
+template<typename P0, typename P1>
+void GridGlue<P0, P1>::reorderIntersections()
+{
+  if (ordering_ == MergerOrdering || index__sz == 0)
+    return;
+
+  typedef unsigned long long Key;
+  std::vector<std::pair<Key, unsigned int> > keys(index__sz);
+
+  if (ordering_ == Grid0ParentOrdering)
+  {
+    // intersections without local grid0 parent go to the end
+    for (unsigned int i = 0; i < index__sz; ++i)
+    {
+      const IntersectionData & data = intersections_[i];
+      Key key = data.grid0local_ ? Key(data.grid0index_) : ~Key(0) >> 32;
+      key = (key << 32) | (data.grid1local_ ? Key(data.grid1index_) : 0);
+      keys[i] = std::make_pair(key, i);
+    }
+  }
+  else
+  {
+    // the centers of the intersections, taken from the local side
+    std::vector<Coords> centers(index__sz);
+    for (unsigned int i = 0; i < index__sz; ++i)
+    {
+      const IntersectionData & data = intersections_[i];
+      centers[i] = 0;
+      if (data.grid0local_)
+      {
+        const typename IntersectionData::Grid0Geometry::GlobalCoordinate c = data.grid0geom_->center();
+        for (int k = 0; k < Grid0View::dimensionworld; ++k)
+          centers[i][k] = c[k];
+      }
+      else if (data.grid1local_)
+      {
+        const typename IntersectionData::Grid1Geometry::GlobalCoordinate c = data.grid1geom_->center();
+        for (int k = 0; k < Grid1View::dimensionworld; ++k)
+          centers[i][k] = c[k];
+      }
+    }
+
+    Dune::GridGlue::MortonCurve<ctype, dimworld> curve(centers);
+    for (unsigned int i = 0; i < index__sz; ++i)
+      keys[i] = std::make_pair(curve.key(centers[i]), i);
+  }
+
+  std::sort(keys.begin(), keys.end());
+
+  // permute the intersections, the end marker stays in place
+  std::vector<IntersectionData> sorted(intersections_.size());
+  std::vector<int> sortedPrevious(index__sz);
+  for (unsigned int i = 0; i < index__sz; ++i)
+  {
+    sorted[i] = intersections_[keys[i].second];
+    sorted[i].index_ = i;
+    sortedPrevious[i] = previousIntersectionIndex_[keys[i].second];
+  }
+  sorted[index__sz] = intersections_[index__sz];
+  intersections_.swap(sorted);
+  previousIntersectionIndex_.swap(sortedPrevious);
+
+#if HAVE_MPI
+  // the local indices refer to the positions in intersections_
+  std::vector<unsigned int> inverse(index__sz);
+  for (unsigned int i = 0; i < index__sz; ++i)
+    inverse[keys[i].second] = i;
+
+  for (typename PIndexSet::iterator it = domain_is_.begin(); it != domain_is_.end(); ++it)
+    it->local() = inverse[it->local().local()];
+  for (typename PIndexSet::iterator it = target_is_.begin(); it != target_is_.end(); ++it)
+    it->local() = inverse[it->local().local()];
+#endif // HAVE_MPI
+}
+
 template<typename T>
 void printVector(const std::vector<T> & v, std::string name)
 {
@@ -421,8 +1191,8 @@ void GridGlue<P0, P1>::mergePatches(
   const bool patch0local = (myrank == patch0rank);
   const bool patch1local = (myrank == patch1rank);
 
-  // remember the number of previous remote intersections
-  const unsigned int offset = intersections_.size();
+  // remember the number of previous intersections
+  const unsigned int offset = index__sz;
 
   std::cout << myrank
             << " GridGlue::mergePatches : rank " << patch0rank << " / " << patch1rank << std::endl;
@@ -462,12 +1232,13 @@ void GridGlue<P0, P1>::mergePatches(
 #endif
     for (unsigned int i = 0; i < merger_->nSimplices(); i++)
     {
-#warning only handle the newest intersections / merger info
-      const IntersectionData & it = intersections_[i];
+      const IntersectionData & it = intersections_[offset+i];
+      // both processes merge the same pair of patches in the same way,
+      // so the intersection number within the pair identifies it globally
       GlobalId gid;
       gid.first.first = patch0rank;
       gid.first.second = patch1rank;
-      gid.second = offset+i;
+      gid.second = i;
       if (it.grid0local_)
       {
         Dune::PartitionType ptype = patch0_.element(it.grid0index_)->partitionType();
@@ -490,13 +1261,13 @@ template<typename P0, typename P1>
 template<typename Extractor>
 void GridGlue<P0, P1>::extractGrid (const Extractor & extractor,
                                     std::vector<Dune::FieldVector<ctype, dimworld> > & coords,
-                                    std::vector<unsigned int> & entities,
-                                    std::vector<Dune::GeometryType>& geometryTypes) const
+                                    PatchTopology & topology) const
 {
   std::vector<typename Extractor::Coords> tempcoords;
   std::vector<typename Extractor::VertexVector> tempentities;
 
   extractor.getCoords(tempcoords);
+  topology.coordinateRevision = extractor.coordinateRevision();
   coords.clear();
   coords.reserve(tempcoords.size());
 
@@ -508,15 +1279,53 @@ void GridGlue<P0, P1>::extractGrid (const Extractor & extractor,
       coords.back()[j] = tempcoords[i][j];
   }
 
+  // the faces are still the same if only the coordinates have changed
+  if (topology.revision == extractor.topologyRevision())
+    return;
+
   extractor.getFaces(tempentities);
-  entities.clear();
+  topology.entities.clear();
 
   for (unsigned int i = 0; i < tempentities.size(); ++i) {
     for (unsigned int j = 0; j < tempentities[i].size(); ++j)
-      entities.push_back(tempentities[i][j]);
+      topology.entities.push_back(tempentities[i][j]);
   }
 
   // get the list of geometry types from the extractor
-  extractor.getGeometryTypes(geometryTypes);
+  extractor.getGeometryTypes(topology.types);
+  topology.revision = extractor.topologyRevision();
+
+}
+
+template<typename P0, typename P1>
+template<typename Extractor>
+bool GridGlue<P0, P1>::subEntityMapping (const Extractor & extractor, const PatchTopology & topology,
+                                         std::vector<int> & old2new, std::vector<bool> & changed) const
+{
+  // every update of the extractor counts in its coordinate revision
+  const unsigned long updates = extractor.coordinateRevision() - topology.coordinateRevision;
+
+  if (updates == 0)
+  {
+    // the patch is the one of the last build
+    const unsigned int n = topology.types.size();
+    old2new.resize(n);
+    for (unsigned int i = 0; i < n; ++i)
+      old2new[i] = i;
+    changed.assign(n, false);
+    return true;
+  }
 
+  if (updates > 1 || !extractor.trackChanges())
+    return false;
+
+  // the extractor knows the changes of its last update only
+  extractor.getSubEntityMapping(old2new);
+  if (old2new.size() != topology.types.size())
+    return false;
+  changed.assign(extractor.nSubEntities(), true);
+  for (unsigned int i = 0; i < old2new.size(); ++i)
+    if (old2new[i] >= 0)
+      changed[old2new[i]] = false;
+  return true;
 }
@@ -23,6 +23,9 @@
 #include <dune/common/array.hh>
 #include <dune/common/exceptions.hh>
 #include <dune/common/iteratorfacades.hh>
+#include <dune/common/shared_ptr.hh>
+
+#include <map>
 
 #define QUICKHACK_INDEX 1
 
@@ -75,6 +78,9 @@ namespace Dune {
     template<typename P0, typename P1, int inside, int outside>
     class CellIntersectionIterator;
 
+    template<typename P0, typename P1, int I>
+    struct QuadraturePoints;
+
   }
 }
 
@@ -114,6 +120,20 @@ struct GridGlueView<P0,P1,1>
  * @tparam P0 patch (extractor) to use for grid 0
  * @tparam P1 patch (extractor) to use for grid 1
  *
+ * \par Thread safety
+ * Once build() has returned, all const methods (intersection iterators,
+ * getIntersection(), quadraturePoints(), the patches' getters) only read
+ * data and may be called concurrently from several threads.  Intersections
+ * refer to the stored geometries by plain pointers, no reference counts are
+ * touched.  build() and communicate() must not run concurrently with any
+ * other access.  See Dune::GridGlue::parallel_for_intersections.
+ *
+ * \par Parallel builds
+ * If one of the grid views is distributed, the glue works on the communicator
+ * of the grid views, and all its ranks have to call build().  Only the ranks
+ * with a non-empty patch exchange their patches; the other ranks leave build()
+ * after one collective call to split the communicator.
+ *
  * \todo adapt member names according to style guide
  */
 template<typename P0, typename P1>
@@ -227,6 +247,16 @@ public:
   /** \brief Type of remote intersection objects */
   typedef Dune::GridGlue::Intersection<P0,P1,0,1> Intersection;
 
+  /** \brief The possible orderings of the intersections after a build */
+  enum IntersectionOrdering {
+    /** \brief keep the order in which the merger produced the intersections */
+    MergerOrdering,
+    /** \brief group the intersections by their grid 0 parent (and then by grid 1 parent) */
+    Grid0ParentOrdering,
+    /** \brief sort the intersections along a Morton curve through their centers */
+    MortonOrdering
+  };
+
   friend class Dune::GridGlue::IntersectionData<P0,P1>;
   friend class Dune::GridGlue::Intersection<P0,P1,0,1>;
   friend class Dune::GridGlue::Intersection<P0,P1,1,0>;
@@ -265,10 +295,69 @@ private:
   /// @brief number of intersections
   IndexType index__sz;
 
+  /// @brief counts the builds, the message sizes cached by communicate() are valid for one build
+  unsigned long buildRevision_;
+
+  /** \brief the faces and geometry types of a patch as passed to the merger */
+  struct PatchTopology
+  {
+    PatchTopology() : revision(0), coordinateRevision(0) {}
+
+    /// @brief the topology revision of the extractor they were read from, 0 if none
+    unsigned long revision;
+
+    /// @brief the coordinate revision of the extractor at the last build, 0 if none
+    unsigned long coordinateRevision;
+
+    std::vector<unsigned int> entities;
+    std::vector<Dune::GeometryType> types;
+  };
+
+  /// @brief the topology of the patches, only read again if the extractors report a change
+  PatchTopology patch0topology_;
+  PatchTopology patch1topology_;
+
+  /** \brief a unique address for each type T */
+  template<class T>
+  struct TypeKey
+  {
+    static const char id;
+  };
+
+  /** \brief type independent base of the buffers of the sequential communicate() */
+  struct SequentialCommBufferBase
+  {
+    virtual ~SequentialCommBufferBase() {}
+  };
+
+  /** \brief the data of all intersections, the data of intersection i starts at offsets[i] */
+  template<class DataType>
+  struct SequentialCommBuffer : public SequentialCommBufferBase
+  {
+    SequentialCommBuffer() : handle(0), dir(-1), revision(0) {}
+
+    std::vector<DataType> data;
+    std::vector<std::size_t> offsets;
+
+    /// @brief the data handle type, direction and build revision the offsets were computed for
+    const void* handle;
+    int dir;
+    unsigned long revision;
+  };
+
+  /// @brief the buffers of the sequential communicate() for each data type, reused across calls
+  mutable std::map<const void*, shared_ptr<SequentialCommBufferBase> > sequentialCommBuffers_;
+
 #if HAVE_MPI
-  /// @brief MPI_Comm which this GridGlue is working on
+  /// @brief the communicator of the grid views, all its ranks have to call build()
+  MPI_Comm parentcomm_;
+
+  /// @brief MPI_Comm which this GridGlue is working on, contains the ranks of parentcomm_ with non-empty patches
   MPI_Comm mpicomm_;
 
+  /// @brief the ranks of mpicomm_ sharing memory with this one, created by the first node-shared exchange
+  MPI_Comm nodecomm_;
+
   /// @brief parallel indexSet for the intersections with a local domain entity
   PIndexSet domain_is_;
 
@@ -277,13 +366,67 @@ private:
 
   /// @brief keeps information about which process has which intersection
   Dune::RemoteIndices<PIndexSet> remoteIndices_;
+
+  /** \brief a communicator set up for one data handle type, with the message sizes it was set up for */
+  struct CachedCommunicator
+  {
+    CachedCommunicator() : revision(0) {}
+
+    shared_ptr<Dune::BufferedCommunicator> communicator;
+    std::vector<std::size_t> sizes;
+
+    /// @brief the build revision the communicator was set up for
+    unsigned long revision;
+  };
+
+  /** \brief identifies a cached communicator: (interface type, direction) and the CommInfo type */
+  typedef std::pair<std::pair<int,int>, const void*> CommunicatorKey;
+
+  /// @brief the communication interfaces for each pair (interface type, direction), built on demand
+  mutable std::map<std::pair<int,int>, shared_ptr<Dune::Interface> > interfaces_;
+
+  /// @brief the communicators built by communicate(), reused as long as the message sizes do not change
+  mutable std::map<CommunicatorKey, CachedCommunicator> communicators_;
+
+  /**
+   * @brief get the communication interface for iftype and dir, build it if it is not cached
+   */
+  const Dune::Interface & communicationInterface(Dune::InterfaceType iftype, Dune::CommunicationDirection dir) const;
 #endif // HAVE_MPI
 
   /// \todo
   typedef Dune::GridGlue::IntersectionData<P0,P1> IntersectionData;
 
-  /// @brief a vector with intersection elements
-  mutable std::vector<IntersectionData>   intersections_;
+  /// @brief a vector with intersection elements, only modified by the build methods
+  std::vector<IntersectionData>   intersections_;
+
+  /// @brief the ordering applied to the intersections after each build
+  IntersectionOrdering ordering_;
+
+  /// @brief patches farther apart than this are not exchanged in a parallel build, negative for no filtering
+  ctype boundingBoxTolerance_;
+
+  /// @brief owned_[i] is true if this rank is responsible for the i'th intersection
+  std::vector<bool> owned_;
+
+  /// @brief receive the remote patches once per node into shared memory (MPI-3 only)
+  bool nodeSharedPatches_;
+
+  /// @brief the index of each intersection before the last build, -1 if it has been computed anew
+  std::vector<int> previousIntersectionIndex_;
+
+  /// @brief the number of intersections before the last build
+  IndexType nPreviousIntersections_;
+
+  /** \brief every intersection has the weight 1 */
+  struct UnitWeight
+  {
+    template<class Intersection>
+    double operator() (const Intersection&) const
+    {
+      return 1.0;
+    }
+  };
 
 protected:
 
@@ -313,11 +456,67 @@ protected:
                     const int patch1rank);
 
 
+  /**
+   * @brief sort the intersections according to ordering_
+   *
+   * The local indices of the parallel index sets and previousIntersectionIndex_
+   * are adapted, the remote indices have to be rebuilt afterwards.
+   */
+  void reorderIntersections();
+
+  /**
+   * @brief make every rank the owner of the intersections with a local domain entity
+   */
+  void resetOwnership();
+
+#if HAVE_MPI && MPI_VERSION >= 3
+  /**
+   * @brief exchange the patches through one shared memory window per node and merge them
+   *
+   * The remote patches are received by one rank per node, in rounds of about
+   * one patch per rank of the node, and stored unpacked in a shared window.
+   *
+   * @param messages the packed local patches
+   * @param allMessageSizes the sizes of the packed patches of all ranks, two per rank
+   * @param needs needs[2*r+p] is true if this rank merges with patch p of rank r
+   */
+  void mergeNodeSharedPatches(const std::vector<char> messages[2],
+                              const std::vector<unsigned int>& allMessageSizes,
+                              const std::vector<char>& needs,
+                              const std::vector<Dune::FieldVector<ctype,dimworld> >& patch0coords,
+                              const std::vector<unsigned int>& patch0entities,
+                              const std::vector<Dune::GeometryType>& patch0types,
+                              const std::vector<Dune::FieldVector<ctype,dimworld> >& patch1coords,
+                              const std::vector<unsigned int>& patch1entities,
+                              const std::vector<Dune::GeometryType>& patch1types);
+#endif
+
+  /**
+   * @brief get the coordinates and the topology of a patch
+   *
+   * The faces and geometry types are only read from the extractor if its
+   * topology has changed since they were read last, e.g. not after
+   * Extractor::refreshCoordinates().
+   */
   template<typename Extractor>
   void extractGrid (const Extractor & extractor,
                     std::vector<Dune::FieldVector<ctype, dimworld> > & coords,
-                    std::vector<unsigned int> & faces,
-                    std::vector<Dune::GeometryType>& geometryTypes) const;
+                    PatchTopology & topology) const;
+
+  /**
+   * @brief map the subentities of a patch at the last build to the current ones, for buildIncremental()
+   *
+   * If the extractor has not been updated since the last build, the map is the
+   * identity.  After exactly one update it is the one of
+   * Extractor::getSubEntityMapping().
+   * @param old2new the current index of each subentity of the last build, or -1 if it has changed
+   * @param changed flags the current subentities that are new or have changed
+   * @return false if the map is unknown because the extractor has been updated more than once
+   * or does not track its changes, then a complete build is needed
+   */
+  template<typename Extractor>
+  bool subEntityMapping (const Extractor & extractor, const PatchTopology & topology,
+                         std::vector<int> & old2new, std::vector<bool> & changed) const;
 
 public:
 
@@ -334,6 +533,17 @@ public:
    * to be a model of the SurfaceMergeConcept.
    */
   GridGlue(const Grid0Patch& gp1, const Grid1Patch& gp2, Merger* merger);
+
+  ~GridGlue();
+
+private:
+
+  /** \brief not copyable, the destructor frees the MPI communicators */
+  GridGlue(const GridGlue&);
+  GridGlue& operator= (const GridGlue&);
+
+public:
+
   /*   G E T T E R S   */
 
   /** \todo Please doc me! */
@@ -356,8 +566,146 @@ public:
 
   /*   F U N C T I O N A L I T Y   */
 
+  /**
+   * @brief compute the intersections of the two patches
+   *
+   * The faces of a patch are only read from its extractor if they may have
+   * changed since the last build.  After Extractor::refreshCoordinates() only
+   * the coordinates are read, the merger is run in any case.
+   */
   void build();
 
+  /**
+   * @brief choose the order of the intersections produced by subsequent builds
+   *
+   * By default the intersections are stored in the order the merger produced them,
+   * which scatters the accesses to the element data of both grids.  Sorting them
+   * by their grid 0 parent or along a space-filling curve improves cache reuse
+   * in loops over the intersections.
+   */
+  void setIntersectionOrdering(IntersectionOrdering ordering)
+  {
+    ordering_ = ordering;
+  }
+
+  /**
+   * @brief set the tolerance for the patch exchange of a parallel build
+   *
+   * In a parallel build a process only receives the remote patches whose bounding
+   * boxes overlap the bounding box of its own patch enlarged by this tolerance.
+   * By default the patches are not filtered, every process receives all
+   * nonempty remote patches.  A tolerance of zero is fine for mergers that only
+   * intersect touching or overlapping patches; mergers that match patches across
+   * a gap need a tolerance at least as large as the gap.  A negative tolerance
+   * switches the filtering off again.
+   */
+  void setBoundingBoxTolerance(ctype tolerance)
+  {
+    boundingBoxTolerance_ = tolerance;
+  }
+
+  /**
+   * @brief receive each remote patch only once per shared memory node
+   *
+   * By default every rank of a parallel build receives the remote patches it
+   * merges with into its own memory.  In this mode the patches are received and
+   * unpacked by one rank per node into MPI-3 shared memory, a few at a time,
+   * and the ranks of the node read them from there.  Patches of ranks on the same node are not sent
+   * at all.  This saves memory and network traffic if many ranks of a node need
+   * the same remote patches.  Without MPI-3 the setting has no effect.
+   */
+  void setNodeSharedPatches(bool shared)
+  {
+    nodeSharedPatches_ = shared;
+  }
+
+  /**
+   * @brief whether this rank is responsible for the i'th intersection
+   *
+   * In a parallel run an intersection between entities of different ranks is
+   * stored on both of them.  Loops that assemble or integrate over the
+   * intersections should skip the ones that are not owned, so that each
+   * intersection is handled exactly once; quadraturePoints() and the
+   * CouplingMatrixAssembler do so.  After build() each rank owns the
+   * intersections with a local domain (grid 0) entity.
+   */
+  bool isOwner(IndexType i) const
+  {
+    return owned_[i];
+  }
+
+  /**
+   * @brief distribute the ownership of the intersections evenly over the ranks
+   *
+   * The intersections between two ranks are split between them such that
+   * the total weight owned by each rank is as even as possible.  Intersections
+   * with both entities on one rank stay with that rank.  All ranks of the glue
+   * have to call this method after build().
+   *
+   * @param weight functor returning the cost of an intersection, seen from grid 0,
+   *        e.g. the number of quadrature points.  The intersections of a pair of
+   *        ranks are ordered by their global id and split where the cumulative
+   *        weight comes closest to the share of the rank of grid 0.
+   * @return the load imbalance of the resulting ownership, i.e. the largest
+   *         owned weight of a rank divided by the mean
+   */
+  template<class Weight>
+  double rebalanceOwnership(const Weight& weight);
+
+  /**
+   * @brief distribute the ownership of the intersections evenly, counting intersections
+   */
+  double rebalanceOwnership()
+  {
+    return rebalanceOwnership(UnitWeight());
+  }
+
+  /**
+   * @brief update the merged grid after a local change of the patches
+   *
+   * Only the intersections of subentities that are new or have changed since the
+   * last build are recomputed, the others are kept.  This requires that
+   * each extractor has been updated at most once since the last build, with
+   * change tracking switched on if it has been updated (see
+   * Extractor::trackChanges()), and that the merger supports incremental builds.
+   * An extractor that has not been updated keeps all its subentities.  Otherwise,
+   * and in parallel runs, this method falls back to a full build().
+   *
+   * Only the intersection computations are saved.  Both patches are still read
+   * from the extractors and all intersections are renumbered, so the cost of a
+   * call remains linear in the size of the patches.
+   *
+   * \note The intersection indices change.  Data attached to intersections has to
+   * be transferred by the user, see previousIntersectionIndex().
+   */
+  void buildIncremental();
+
+  /**
+   * @brief the index an intersection had before the last build
+   *
+   * After buildIncremental() the kept intersections are renumbered, this gives
+   * their index before the call, e.g. to transfer data attached to them.
+   * Intersections computed anew, and all intersections after build(), get -1.
+   * @param i the current index of the intersection
+   */
+  int previousIntersectionIndex(IndexType i) const
+  {
+    return i < previousIntersectionIndex_.size() ? previousIntersectionIndex_[i] : -1;
+  }
+
+  /**
+   * @brief map the intersection indices before the last build to the current ones
+   * @param old2new will be resized to the number of intersections before the last build
+   * and contains the current index, or -1 if the intersection is gone or was computed anew
+   */
+  void getIntersectionMapping(std::vector<int>& old2new) const
+  {
+    old2new.assign(nPreviousIntersections_, -1);
+    for (unsigned int i = 0; i < previousIntersectionIndex_.size(); ++i)
+      if (previousIntersectionIndex_[i] >= 0)
+        old2new[previousIntersectionIndex_[i]] = i;
+  }
+
   /*   I N T E R S E C T I O N S   A N D   I N T E R S E C T I O N   I T E R A T O R S   */
 
   /**
@@ -392,6 +740,10 @@ public:
      \param iftype Interface for which the Communication should take place
      \param dir Communication direction (Forward means Domain to Target, Backward is the reverse)
 
+     On a single rank only the owned intersections are communicated, see isOwner().
+     An intersection shared by two ranks is exchanged between them whoever owns it,
+     because the owner needs the data of the other side.
+
      \todo seq->seq use commSeq
      \todo seq->par use commSeq
      \todo par->seq use commPar
@@ -403,8 +755,37 @@ public:
   void communicate (Dune::GridGlue::CommDataHandle<DataHandleImp,DataTypeImp> & data,
                     Dune::InterfaceType iftype, Dune::CommunicationDirection dir) const
   {
-    typedef Dune::GridGlue::CommDataHandle<DataHandleImp,DataTypeImp> DataHandle;
+    communicateImpl(data, static_cast<const DataHandleImp&>(data).fixedSize(), iftype, dir);
+  }
+
+  /*! \brief Communicate information on the MergedGrid of a GridGlue, block by block
+
+     Like the method above, but the data of each intersection is gathered
+     and scattered as a contiguous array.
+
+     Template parameter is a model of Dune::GridGlue::BlockCommDataHandle
+   */
+  template<class DataHandleImp, class DataTypeImp>
+  void communicate (Dune::GridGlue::BlockCommDataHandle<DataHandleImp,DataTypeImp> & data,
+                    Dune::InterfaceType iftype, Dune::CommunicationDirection dir) const
+  {
+    communicateImpl(data, static_cast<const DataHandleImp&>(data).fixedSize(), iftype, dir);
+  }
+
+private:
+
+  /**
+   * \brief implementation of communicate() for both kinds of data handles
+   *
+   * \param fixedSize whether the sizes of the handle only depend on the intersections,
+   * then they are only computed again after the next build
+   */
+  template<class DataHandle>
+  void communicateImpl (DataHandle & data, bool fixedSize,
+                        Dune::InterfaceType iftype, Dune::CommunicationDirection dir) const
+  {
     typedef typename DataHandle::DataType DataType;
+    typedef Dune::GridGlue::BlockAccess<DataHandle> Access;
 
 #if HAVE_MPI
 
@@ -413,48 +794,33 @@ public:
       /*
        * P A R A L L E L   V E R S I O N
        */
-      // setup communication interfaces
-      typedef Dune::EnumItem <Dune::PartitionType, Dune::InteriorEntity> InteriorFlags;
-      typedef Dune::EnumItem <Dune::PartitionType, Dune::OverlapEntity>  OverlapFlags;
-      typedef Dune::EnumRange <Dune::PartitionType, Dune::InteriorEntity, Dune::GhostEntity>  AllFlags;
-      Dune::Interface interface;
-      switch (iftype)
-      {
-      case Dune::InteriorBorder_InteriorBorder_Interface :
-        interface.build (remoteIndices_, InteriorFlags(), InteriorFlags() );
-        break;
-      case Dune::InteriorBorder_All_Interface :
-        if (dir == Dune::ForwardCommunication)
-          interface.build (remoteIndices_, InteriorFlags(), AllFlags() );
-        else
-          interface.build (remoteIndices_, AllFlags(), InteriorFlags() );
-        break;
-      case Dune::Overlap_OverlapFront_Interface :
-        interface.build (remoteIndices_, OverlapFlags(), OverlapFlags() );
-        break;
-      case Dune::Overlap_All_Interface :
-        if (dir == Dune::ForwardCommunication)
-          interface.build (remoteIndices_, OverlapFlags(), AllFlags() );
-        else
-          interface.build (remoteIndices_, AllFlags(), OverlapFlags() );
-        break;
-      case Dune::All_All_Interface :
-        interface.build (remoteIndices_, AllFlags(), AllFlags() );
-        break;
-      default :
-        DUNE_THROW(Dune::NotImplemented, "GridGlue::communicate for interface " << iftype << " not implemented");
-      }
-
       // setup communication info (class needed to tunnel all info to the operator)
-      typedef Dune::GridGlue::CommInfo<GridGlue,DataHandleImp,DataTypeImp> CommInfo;
+      typedef Dune::GridGlue::CommInfo<GridGlue,DataHandle> CommInfo;
       CommInfo commInfo;
       commInfo.dir = dir;
       commInfo.gridglue = this;
       commInfo.data = &data;
 
-      // create communicator
-      Dune::BufferedCommunicator bComm ;
-      bComm.template build< CommInfo >(commInfo, commInfo, interface);
+      // reuse the communicator of a previous call if the message sizes are the same,
+      // which is known without asking the handle if its sizes are fixed
+      const CommunicatorKey key(std::make_pair(int(iftype), int(dir)), &TypeKey<CommInfo>::id);
+      CachedCommunicator & cached = communicators_[key];
+
+      if (!cached.communicator || cached.revision != buildRevision_ || !fixedSize)
+      {
+        std::vector<std::size_t> sizes(index__sz);
+        for (IndexType i = 0; i < index__sz; ++i)
+          sizes[i] = Dune::CommPolicy<CommInfo>::getSize(commInfo, i);
+
+        if (!cached.communicator || cached.revision != buildRevision_ || cached.sizes != sizes)
+        {
+          cached.communicator = shared_ptr<Dune::BufferedCommunicator>(new Dune::BufferedCommunicator);
+          cached.communicator->template build< CommInfo >(commInfo, commInfo, communicationInterface(iftype, dir));
+          cached.sizes.swap(sizes);
+          cached.revision = buildRevision_;
+        }
+      }
+      Dune::BufferedCommunicator & bComm = *cached.communicator;
 
       // do communication
       // choose communication direction.
@@ -470,22 +836,49 @@ public:
        * S E Q U E N T I A L   V E R S I O N
        */
 
-      // get comm buffer size
-      int ssz = indexSet_size() * 10;       // times data per intersection
-      int rsz = indexSet_size() * 10;
-
-      // allocate send/receive buffer
-      DataType* sendbuffer = new DataType[ssz];
-      DataType* receivebuffer = new DataType[rsz];
+      typedef SequentialCommBuffer<DataType> Buffer;
+      shared_ptr<SequentialCommBufferBase> & bufferBase = sequentialCommBuffers_[&TypeKey<DataType>::id];
+      if (!bufferBase)
+        bufferBase = shared_ptr<SequentialCommBufferBase>(new Buffer);
+      Buffer & buffer = static_cast<Buffer &>(*bufferBase);
 
       // iterators
       Grid0IntersectionIterator rit = ibegin<0>();
       Grid0IntersectionIterator ritend = iend<0>();
 
+      // get comm buffer size, intersections without data on the sending side contribute nothing;
+      // the offsets of the previous call are still valid if the handle has fixed sizes
+      if (!fixedSize || buffer.handle != &TypeKey<DataHandle>::id
+          || buffer.dir != int(dir) || buffer.revision != buildRevision_)
+      {
+        buffer.offsets.resize(index__sz + 1);
+        buffer.offsets[0] = 0;
+        std::size_t k = 0;
+        for (; rit != ritend; ++rit, ++k)
+        {
+          const bool sending = isOwner(k)
+                               && ((dir == Dune::ForwardCommunication) ? rit->self() : rit->neighbor());
+          buffer.offsets[k+1] = buffer.offsets[k] + (sending ? data.size(*rit) : 0);
+        }
+
+        buffer.handle = &TypeKey<DataHandle>::id;
+        buffer.dir = dir;
+        buffer.revision = buildRevision_;
+      }
+
+      // the buffer only grows, so repeated communication does not allocate
+      if (buffer.data.size() < buffer.offsets[index__sz])
+        buffer.data.resize(buffer.offsets[index__sz]);
+
       // gather
-      Dune::GridGlue::StreamingMessageBuffer<DataType> gatherbuffer(sendbuffer);
-      for (; rit != ritend; ++rit)
+      std::size_t k = 0;
+      for (rit = ibegin<0>(); rit != ritend; ++rit, ++k)
       {
+        const std::size_t n = buffer.offsets[k+1] - buffer.offsets[k];
+        if (n == 0)
+          continue;
+
+        DataType* values = &buffer.data[buffer.offsets[k]];
         /*
            we need to have to variants depending on the communication direction.
          */
@@ -494,31 +887,26 @@ public:
           /*
              dir : Forward (domain -> target)
            */
-          if (rit->self())
-          {
-            data.gather(gatherbuffer, rit->inside(), *rit);
-          }
+          Access::gather(data, rit->inside(), *rit, values, n);
         }
         else         // (dir == Dune::BackwardCommunication)
         {
           /*
              dir : Backward (target -> domain)
            */
-          if (rit->neighbor())
-          {
-            data.gather(gatherbuffer, rit->outside(), *rit);
-          }
+          Access::gather(data, rit->outside(), *rit, values, n);
         }
       }
 
-      assert(ssz == rsz);
-      for (int i=0; i<ssz; i++)
-        receivebuffer[i] = sendbuffer[i];
-
-      // scatter
-      Dune::GridGlue::StreamingMessageBuffer<DataType> scatterbuffer(receivebuffer);
-      for (rit = ibegin<0>(); rit != ritend; ++rit)
+      // scatter, directly from the gathered data
+      k = 0;
+      for (rit = ibegin<0>(); rit != ritend; ++rit, ++k)
       {
+        const std::size_t n = buffer.offsets[k+1] - buffer.offsets[k];
+        if (n == 0)
+          continue;
+
+        const DataType* values = &buffer.data[buffer.offsets[k]];
         /*
            we need to have to variants depending on the communication direction.
          */
@@ -528,8 +916,7 @@ public:
              dir : Forward (domain -> target)
            */
           if (rit->neighbor())
-            data.scatter(scatterbuffer, rit->outside(), *rit,
-                         data.size(*rit));
+            Access::scatter(data, rit->outside(), *rit, values, n);
         }
         else         // (dir == Dune::BackwardCommunication)
         {
@@ -537,17 +924,31 @@ public:
              dir : Backward (target -> domain)
            */
           if (rit->self())
-            data.scatter(scatterbuffer, rit->inside(), *rit,
-                         data.size(*rit));
+            Access::scatter(data, rit->inside(), *rit, values, n);
         }
       }
-
-      // cleanup pointers
-      delete[] sendbuffer;
-      delete[] receivebuffer;
     }
   }
 
+public:
+
+  /**
+   * @brief evaluate a quadrature rule on all intersections at once
+   *
+   * For each intersection with local inside and outside entities the world positions,
+   * the positions in the inside and outside elements and the integration element are
+   * stored in the contiguous arrays of @c points.  This avoids the per-point virtual
+   * geometry calls of the intersection interface and the work is distributed over
+   * threads if OpenMP is enabled.
+   *
+   * @tparam I the patch whose entities are regarded as inside
+   * @param quad a quadrature rule on the reference simplex of the intersections
+   * @param points the output, see Dune::GridGlue::QuadraturePoints
+   */
+  template<int I>
+  void quadraturePoints(const typename Dune::GridGlue::QuadraturePoints<P0,P1,I>::QuadratureRule& quad,
+                        Dune::GridGlue::QuadraturePoints<P0,P1,I>& points) const;
+
 #if QUICKHACK_INDEX
   /*
    * @brief return an IndexSet mapping from Intersection to IndexType
@@ -566,6 +967,16 @@ public:
     return Intersection(this, & intersections_[i]);
   }
 
+  /** \brief get the i'th intersection, with the entities of patch I on the inside
+   *
+   * Random access in constant time, safe to call from several threads.
+   */
+  template<int I>
+  Dune::GridGlue::Intersection<P0,P1,I,1-I> getIntersection(int i) const
+  {
+    return Dune::GridGlue::Intersection<P0,P1,I,1-I>(this, & intersections_[i]);
+  }
+
   size_t size() const
   {
     return index__sz;
@@ -577,5 +988,6 @@ public:
 
 #include "intersection.hh"
 #include "intersectioniterator.hh"
+#include "quadraturepoints.hh"
 
 #endif // GRIDGLUE_HH
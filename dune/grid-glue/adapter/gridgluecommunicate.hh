@@ -13,6 +13,9 @@
 #include <dune/grid/common/datahandleif.hh>
 #include <dune/grid/common/gridenums.hh>
 
+#include <cassert>
+#include <vector>
+
 #if DUNE_VERSION_NEWER_REV(DUNE_COMMON,2,1,0)
   #include <dune/common/parallel/communicator.hh>
 #else
@@ -72,6 +75,16 @@ namespace Dune {
         return asImp().size(i);
       }
 
+      /*! whether size() only depends on the intersection, i.e. is the same for all
+         objects of the data handle class.  Then communicate() only asks for the
+         sizes once after each build of the GridGlue.  Data handles can hide this
+         default, which is false.
+       */
+      bool fixedSize () const
+      {
+        return false;
+      }
+
       /** @brief pack data from user to message buffer
           @param buff message buffer provided by the grid
           @param e entity for which date should be packed to buffer
@@ -109,6 +122,87 @@ namespace Dune {
       }
     }; // end class CommDataHandleIF
 
+    /**
+       \brief describes the features of a block data handle for
+       communication using the GridGlue::communicate methods.
+
+       In contrast to CommDataHandle, the data of an intersection is gathered
+       into and scattered from a contiguous array at once, instead of value by
+       value through a message buffer.  This avoids a call per value for
+       vector-valued data.
+
+       \tparam DataHandleImp implementation of the users data handle
+       \tparam DataTypeImp type of data that are going to be communicated which is exported as \c DataType (for example double)
+       \ingroup GridGlueCommunication
+     */
+    template <class DataHandleImp, class DataTypeImp>
+    class BlockCommDataHandle
+    {
+    public:
+      //! data type of data to communicate
+      typedef DataTypeImp DataType;
+
+    protected:
+      // one should not create an explicit instance of this inteface object
+      BlockCommDataHandle() {}
+
+    public:
+
+      /*! how many objects of type DataType have to be sent for a given intersection
+         Note: Both sender and receiver side need to know this size.
+       */
+      template<class RISType>
+      size_t size (RISType& i) const
+      {
+        CHECK_INTERFACE_IMPLEMENTATION((asImp().size(i)));
+        return asImp().size(i);
+      }
+
+      /*! whether size() only depends on the intersection, i.e. is the same for all
+         objects of the data handle class.  Then communicate() only asks for the
+         sizes once after each build of the GridGlue.  Data handles can hide this
+         default, which is false.
+       */
+      bool fixedSize () const
+      {
+        return false;
+      }
+
+      /** @brief write the data of an intersection to values
+          @param e entity for which date should be packed
+          @param i Intersection for which date should be packed
+          @param values array of size(i) entries
+       */
+      template<class EntityType, class RISType>
+      void gather (const EntityType& e, const RISType & i, DataType* values) const
+      {
+        CHECK_AND_CALL_INTERFACE_IMPLEMENTATION((asImp().gather(e,i,values)));
+      }
+
+      /** @brief read the data of an intersection from values
+          @param e entity for which date should be unpacked
+          @param i Intersection for which date should be unpacked
+          @param values array of n entries
+          @param n number of data written by the sender for this intersection
+       */
+      template<class EntityType, class RISType>
+      void scatter (const EntityType& e, const RISType & i, const DataType* values, size_t n)
+      {
+        CHECK_AND_CALL_INTERFACE_IMPLEMENTATION((asImp().scatter(e,i,values,n)));
+      }
+
+    private:
+      //!  Barton-Nackman trick
+      DataHandleImp& asImp () {
+        return static_cast<DataHandleImp &> (*this);
+      }
+      //!  Barton-Nackman trick
+      const DataHandleImp& asImp () const
+      {
+        return static_cast<const DataHandleImp &>(*this);
+      }
+    }; // end class BlockCommDataHandle
+
     /**
        Streaming MessageBuffer for the GridGlue communication
        \ingroup GridGlueCommunication
@@ -118,10 +212,11 @@ namespace Dune {
     public:
       typedef DT value_type;
 
-      // Constructor
-      StreamingMessageBuffer (DT *p)
+      // Constructor, p points to an array of n entries
+      StreamingMessageBuffer (DT *p, size_t n)
       {
         a=p;
+        capacity=n;
         i=0;
         j=0;
       }
@@ -131,6 +226,7 @@ namespace Dune {
       void write (const Y& data)
       {
         dune_static_assert(( is_same<DT,Y>::value ), "DataType missmatch");
+        assert(i < capacity && "the data handle writes more values than its size()");
         a[i++] = data;
       }
 
@@ -139,6 +235,7 @@ namespace Dune {
       void read (Y& data) const
       {
         dune_static_assert(( is_same<DT,Y>::value ), "DataType missmatch");
+        assert(j < capacity && "the data handle reads more values than were sent");
         data = a[j++];
       }
 
@@ -155,10 +252,57 @@ namespace Dune {
     private:
 #endif
       DT *a;
+      size_t capacity;
       size_t i;
       mutable size_t j;
     };
 
+    /**
+       \brief gather and scatter the data of one intersection through a contiguous array,
+       for both kinds of data handles
+     */
+    template<class DataHandle>
+    struct BlockAccess;
+
+    template <class DataHandleImp, class DataTypeImp>
+    struct BlockAccess< CommDataHandle<DataHandleImp, DataTypeImp> >
+    {
+      typedef CommDataHandle<DataHandleImp, DataTypeImp> DataHandle;
+
+      template<class EntityType, class RISType>
+      static void gather (const DataHandle& data, const EntityType& e, const RISType & i, DataTypeImp* values, size_t n)
+      {
+        StreamingMessageBuffer<DataTypeImp> buffer(values, n);
+        data.gather(buffer, e, i);
+        assert(buffer.counter() == n && "the data handle writes fewer values than its size()");
+      }
+
+      template<class EntityType, class RISType>
+      static void scatter (DataHandle& data, const EntityType& e, const RISType & i, const DataTypeImp* values, size_t n)
+      {
+        StreamingMessageBuffer<DataTypeImp> buffer(const_cast<DataTypeImp*>(values), n);
+        data.scatter(buffer, e, i, n);
+      }
+    };
+
+    template <class DataHandleImp, class DataTypeImp>
+    struct BlockAccess< BlockCommDataHandle<DataHandleImp, DataTypeImp> >
+    {
+      typedef BlockCommDataHandle<DataHandleImp, DataTypeImp> DataHandle;
+
+      template<class EntityType, class RISType>
+      static void gather (const DataHandle& data, const EntityType& e, const RISType & i, DataTypeImp* values, size_t n)
+      {
+        data.gather(e, i, values);
+      }
+
+      template<class EntityType, class RISType>
+      static void scatter (DataHandle& data, const EntityType& e, const RISType & i, const DataTypeImp* values, size_t n)
+      {
+        data.scatter(e, i, values, n);
+      }
+    };
+
     /**
        \brief forward gather scatter to user defined CommInfo class
 
@@ -172,66 +316,75 @@ namespace Dune {
       template<class CommInfo>
       static const typename CommInfo::DataType& gather(const CommInfo& commInfo, size_t i, size_t j = 0)
       {
-        // get Intersection
-        typedef typename CommInfo::GridGlue::Intersection Intersection;
-        Intersection ris(commInfo.gridglue->getIntersection(i));
+        typedef BlockAccess<typename CommInfo::DataHandle> Access;
 
         // fill buffer if we have a new intersection
         if (j == 0)
         {
-          commInfo.mbuffer.clear();
+          // get Intersection
+          typedef typename CommInfo::GridGlue::Intersection Intersection;
+          Intersection ris(commInfo.gridglue->getIntersection(i));
+
+          commInfo.currentsize = commInfo.data->size(ris);
+          if (commInfo.buffer.size() < commInfo.currentsize)
+            commInfo.buffer.resize(commInfo.currentsize);
+
           if (dir == Dune::ForwardCommunication)
           {
             // read from domain
             if(ris.self())
-              commInfo.data->gather(commInfo.mbuffer, ris.inside(), ris);
+              Access::gather(*commInfo.data, ris.inside(), ris, &commInfo.buffer[0], commInfo.currentsize);
           }
           else   // (dir == Dune::BackwardCommunication)
           {
             // read from target
             if(ris.neighbor())
-              commInfo.data->gather(commInfo.mbuffer, ris.outside(), ris);
+              Access::gather(*commInfo.data, ris.outside(), ris, &commInfo.buffer[0], commInfo.currentsize);
           }
         }
 
         // return the j'th value in the buffer
-        assert(j < commInfo.mbuffer.i);
+        assert(j < commInfo.currentsize);
         return commInfo.buffer[j];
       }
 
       template<class CommInfo>
       static void scatter(CommInfo& commInfo, const typename CommInfo::DataType& v, std::size_t i, std::size_t j = 0)
       {
+        typedef BlockAccess<typename CommInfo::DataHandle> Access;
+
         // extract GridGlue objects...
         typedef typename CommInfo::GridGlue::Intersection Intersection;
-        Intersection ris(commInfo.gridglue->getIntersection(i));
 
         // get size if we have a new intersection
         if (j == 0)
         {
-          commInfo.mbuffer.clear();
+          Intersection ris(commInfo.gridglue->getIntersection(i));
           commInfo.currentsize = commInfo.data->size(ris);
+          if (commInfo.buffer.size() < commInfo.currentsize)
+            commInfo.buffer.resize(commInfo.currentsize);
         }
 
         // write entry to buffer
+        assert(j < commInfo.currentsize);
         commInfo.buffer[j] = v;
 
         // write back the buffer if we are at the end of this intersection
         if (j == commInfo.currentsize-1)
         {
+          Intersection ris(commInfo.gridglue->getIntersection(i));
           if (dir == Dune::ForwardCommunication)
           {
             // write to target
             if(ris.neighbor())
-              commInfo.data->scatter(commInfo.mbuffer, ris.outside(), ris, commInfo.currentsize);
+              Access::scatter(*commInfo.data, ris.outside(), ris, &commInfo.buffer[0], commInfo.currentsize);
           }
           else   // (dir == Dune::BackwardCommunication)
           {
             // write to domain
             if(ris.self())
-              commInfo.data->scatter(commInfo.mbuffer, ris.inside(), ris, commInfo.currentsize);
+              Access::scatter(*commInfo.data, ris.inside(), ris, &commInfo.buffer[0], commInfo.currentsize);
           }
-          assert(commInfo.mbuffer.j <= commInfo.currentsize);
         }
       }
     };
@@ -243,24 +396,25 @@ namespace Dune {
        \brief collects all GridGlue data requried for communication
        \ingroup GridGlueCommunication
      */
-    template <typename GG, class DataHandleImp, class DataTypeImp>
+    template <typename GG, class DataHandleType>
     struct CommInfo
     {
-      typedef DataTypeImp value_type;
+      typedef typename DataHandleType::DataType value_type;
       typedef GG GridGlue;
-      typedef DataTypeImp DataType;
+      typedef typename DataHandleType::DataType DataType;
+      typedef DataHandleType DataHandle;
 
-      CommInfo() : buffer(100), mbuffer(&buffer[0])
+      CommInfo() : currentsize(0)
       {}
 
       // tunnel information to the policy and the operators
       const GridGlue * gridglue;
-      ::Dune::GridGlue::CommDataHandle<DataHandleImp, DataTypeImp> * data;
+      DataHandle * data;
 
       // state variables
-      std::vector<DataType> buffer;
-      mutable ::Dune::GridGlue::StreamingMessageBuffer<DataType> mbuffer;
-      size_t currentsize;
+      // the values of the current intersection, grows to the largest number of values
+      mutable std::vector<DataType> buffer;
+      mutable size_t currentsize;
       Dune::CommunicationDirection dir;
     };
 
@@ -270,18 +424,18 @@ namespace Dune {
   /**
      \brief specialization of the CommPolicy struct, required for the ParallelIndexsets
    */
-  template<typename GG, class DataHandleImp, class DataTypeImp>
-  struct CommPolicy< ::Dune::GridGlue::CommInfo<GG, DataHandleImp, DataTypeImp> >
+  template<typename GG, class DataHandleType>
+  struct CommPolicy< ::Dune::GridGlue::CommInfo<GG, DataHandleType> >
   {
     /**
      * @brief The type of the GridGlueCommInfo
      */
-    typedef ::Dune::GridGlue::CommInfo<GG, DataHandleImp, DataTypeImp> Type;
+    typedef ::Dune::GridGlue::CommInfo<GG, DataHandleType> Type;
 
     /**
      * @brief The datatype that should be communicated.
      */
-    typedef DataTypeImp IndexedType;
+    typedef typename DataHandleType::DataType IndexedType;
 
     /**
      * @brief Each intersection can communicate a different number of objects.
@@ -89,6 +89,37 @@ namespace Dune {
       shared_ptr<Grid1LocalGeometry>  grid1localgeom_;
       shared_ptr<Grid1Geometry>       grid1geom_;
 
+    private:
+
+      /**
+         @brief map points from the coordinates of an extracted subentity to element and world coordinates
+
+         Uses the corner tables of the patch if possible, and the full geometries otherwise.
+       */
+      template<class Patch, class SubEntityPoints, class ElementPoints, class WorldPoints>
+      static void mapSubEntityPoints(const Patch& patch, unsigned int index, const SubEntityPoints& subEntityPoints,
+                                     ElementPoints& elementPoints, WorldPoints& worldPoints)
+      {
+        if (patch.hasCornerGeometry(index))
+        {
+          const typename Patch::WorldCornerGeometry worldGeometry = patch.cornerGeometry(index);
+          const typename Patch::LocalCornerGeometry localGeometry = patch.localCornerGeometry(index);
+          for (std::size_t i=0; i<subEntityPoints.size(); i++) {
+            elementPoints[i] = localGeometry.global(subEntityPoints[i]);
+            worldPoints[i]   = worldGeometry.global(subEntityPoints[i]);
+          }
+        }
+        else
+        {
+          const typename Patch::Geometry worldGeometry = patch.geometry(index);
+          const typename Patch::LocalGeometry localGeometry = patch.geometryLocal(index);
+          for (std::size_t i=0; i<subEntityPoints.size(); i++) {
+            elementPoints[i] = localGeometry.global(subEntityPoints[i]);
+            worldPoints[i]   = worldGeometry.global(subEntityPoints[i]);
+          }
+        }
+      }
+
     };
 
     //! \todo move this functionality to GridGlue
@@ -131,15 +162,8 @@ namespace Dune {
         if (grid0local)
         {
           grid0index_ = glue.merger_->template parent<0>(mergeindex);
-          typename GridGlue::Grid0Patch::Geometry
-          domainWorldGeometry = glue.template patch<0>().geometry(grid0index_);
-          typename GridGlue::Grid0Patch::LocalGeometry
-          domainLocalGeometry = glue.template patch<0>().geometryLocal(grid0index_);
-
-          for (std::size_t i=0; i<corners_subEntity_local.size(); i++) {
-            corners_element_local[i] = domainLocalGeometry.global(corners_subEntity_local[i]);
-            corners_global[i]        = domainWorldGeometry.global(corners_subEntity_local[i]);
-          }
+          mapSubEntityPoints(glue.template patch<0>(), grid0index_, corners_subEntity_local,
+                             corners_element_local, corners_global);
 
           // set the corners of the geometries
 #ifdef ONLY_SIMPLEX_INTERSECTIONS
@@ -172,15 +196,8 @@ namespace Dune {
         if (grid1local)
         {
           grid1index_ = glue.merger_->template parent<1>(mergeindex);
-          typename GridGlue::Grid1Patch::Geometry
-          targetWorldGeometry = glue.template patch<1>().geometry(grid1index_);
-          typename GridGlue::Grid1Patch::LocalGeometry
-          targetLocalGeometry = glue.template patch<1>().geometryLocal(grid1index_);
-
-          for (std::size_t i=0; i<corners_subEntity_local.size(); i++) {
-            corners_element_local[i] = targetLocalGeometry.global(corners_subEntity_local[i]);
-            corners_global[i]        = targetWorldGeometry.global(corners_subEntity_local[i]);
-          }
+          mapSubEntityPoints(glue.template patch<1>(), grid1index_, corners_subEntity_local,
+                             corners_element_local, corners_global);
 
           // set the corners of the geometries
 #ifdef ONLY_SIMPLEX_INTERSECTIONS
@@ -420,8 +437,8 @@ namespace Dune {
       Dune::GeometryType type() const
       {
         #ifdef ONLY_SIMPLEX_INTERSECTIONS
-        static const Dune::GeometryType type(Dune::GeometryType::simplex, mydim);
-        return type;
+        // no function-local static here: its initialization would not be thread-safe
+        return Dune::GeometryType(Dune::GeometryType::simplex, mydim);
         #else
         #error Not Implemented
         #endif
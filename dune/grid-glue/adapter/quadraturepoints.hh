@@ -0,0 +1,196 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+/**
+   @file
+   @brief Evaluation of a quadrature rule on all intersections of a GridGlue at once
+ */
+
+#ifndef DUNE_GRIDGLUE_QUADRATUREPOINTS_HH
+#define DUNE_GRIDGLUE_QUADRATUREPOINTS_HH
+
+#include <vector>
+
+#include <dune/common/array.hh>
+#include <dune/common/fvector.hh>
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/grid-glue/common/parallelfor.hh>
+#include <dune/grid-glue/adapter/gridglue.hh>
+
+namespace Dune {
+  namespace GridGlue {
+
+    /**
+       @brief Quadrature points of all intersections, stored in contiguous arrays
+
+       The points of the b'th block belong to the intersection with index
+       intersections[b] and are stored at the positions
+       b*nPoints ... (b+1)*nPoints-1 of the arrays global, inside and outside.
+       Only intersections whose inside and outside entities are both local and
+       which are owned by this rank, see GridGlue::isOwner(), are contained.
+
+       \tparam I the patch whose entities are regarded as inside (0 or 1)
+     */
+    template<typename P0, typename P1, int I>
+    struct QuadraturePoints
+    {
+      typedef IntersectionTraits<P0,P1,I,1-I> Traits;
+
+      typedef typename Traits::ctype ctype;
+
+      enum {
+        /** \brief Dimension of the intersections */
+        mydim = Traits::mydim
+      };
+
+      /** \brief The quadrature rule type to be used on the intersections */
+      typedef Dune::QuadratureRule<ctype, mydim> QuadratureRule;
+
+      /** \brief World coordinates, as returned by Intersection::geometry() */
+      typedef typename Traits::Geometry::GlobalCoordinate GlobalCoordinate;
+
+      /** \brief Coordinates in the inside element, as returned by Intersection::geometryInInside() */
+      typedef typename Traits::InsideLocalGeometry::GlobalCoordinate InsideCoordinate;
+
+      /** \brief Coordinates in the outside element, as returned by Intersection::geometryInOutside() */
+      typedef typename Traits::OutsideLocalGeometry::GlobalCoordinate OutsideCoordinate;
+
+      QuadraturePoints() : nPoints(0) {}
+
+      /** \brief number of intersections (blocks) */
+      std::size_t size() const
+      {
+        return intersections.size();
+      }
+
+      /** \brief position of the q'th point of block b in the point arrays */
+      std::size_t index(std::size_t b, unsigned int q) const
+      {
+        return b*nPoints + q;
+      }
+
+      /// @brief number of quadrature points per intersection
+      unsigned int nPoints;
+
+      /// @brief the intersection index of each block
+      std::vector<unsigned int> intersections;
+
+      /// @brief the quadrature weights, the same for each block
+      std::vector<ctype> weights;
+
+      /// @brief the integration element of each block (the intersections are affine)
+      std::vector<ctype> integrationElements;
+
+      /// @brief the world positions of the points
+      std::vector<GlobalCoordinate> global;
+
+      /// @brief the positions of the points in the inside elements
+      std::vector<InsideCoordinate> inside;
+
+      /// @brief the positions of the points in the outside elements
+      std::vector<OutsideCoordinate> outside;
+    };
+
+    namespace Detail {
+
+      /** \brief map the reference points xi through the affine (simplex) geometry */
+      template<int mydim, class Geometry, class ctype, class Coordinate>
+      void affineMap(const Geometry& geometry, const std::vector<ctype>& xi, Coordinate* out)
+      {
+        const std::size_t nPoints = xi.size() / mydim;
+
+        const Coordinate origin = geometry.corner(0);
+        Dune::array<Coordinate, mydim> directions;
+        for (int k = 0; k < mydim; ++k)
+          directions[k] = geometry.corner(k+1) - origin;
+
+        for (std::size_t q = 0; q < nPoints; ++q)
+        {
+          out[q] = origin;
+          for (int k = 0; k < mydim; ++k)
+            out[q].axpy(xi[q*mydim+k], directions[k]);
+        }
+      }
+
+      /** \brief compute the quadrature points of a range of blocks */
+      template<class Points, class InsideView, class OutsideView, class IntersectionData>
+      struct QuadraturePointsChunk
+      {
+        typedef typename Points::ctype ctype;
+
+        QuadraturePointsChunk(const std::vector<IntersectionData>& intersections,
+                              const std::vector<ctype>& xi, Points& points)
+          : intersections_(intersections), xi_(xi), points_(points)
+        {}
+
+        void operator() (std::size_t begin, std::size_t end) const
+        {
+          for (std::size_t b = begin; b < end; ++b)
+          {
+            const IntersectionData & data = intersections_[points_.intersections[b]];
+
+            points_.integrationElements[b] =
+              InsideView::geometry(data).integrationElement(Dune::FieldVector<ctype, Points::mydim>(0));
+
+            if (points_.nPoints == 0)
+              continue;
+
+            const std::size_t first = points_.index(b, 0);
+            affineMap<Points::mydim>(InsideView::geometry(data), xi_, &points_.global[first]);
+            affineMap<Points::mydim>(InsideView::localGeometry(data), xi_, &points_.inside[first]);
+            affineMap<Points::mydim>(OutsideView::localGeometry(data), xi_, &points_.outside[first]);
+          }
+        }
+
+        const std::vector<IntersectionData>& intersections_;
+        const std::vector<ctype>& xi_;
+        Points& points_;
+      };
+
+    } // end namespace Detail
+
+  } // end namespace GridGlue
+} // end namespace Dune
+
+template<typename P0, typename P1>
+template<int I>
+void GridGlue<P0, P1>::quadraturePoints(const typename Dune::GridGlue::QuadraturePoints<P0,P1,I>::QuadratureRule& quad,
+                                        Dune::GridGlue::QuadraturePoints<P0,P1,I>& points) const
+{
+  typedef Dune::GridGlue::QuadraturePoints<P0,P1,I> Points;
+  typedef Dune::GridGlue::IntersectionDataView<P0,P1,I> InsideView;
+  typedef Dune::GridGlue::IntersectionDataView<P0,P1,1-I> OutsideView;
+
+  const int mydim = Points::mydim;
+  const unsigned int nPoints = quad.size();
+
+  // the owned intersections with both entities available
+  points.intersections.clear();
+  for (IndexType i = 0; i < index__sz; ++i)
+    if (InsideView::local(intersections_[i]) && OutsideView::local(intersections_[i]) && isOwner(i))
+      points.intersections.push_back(i);
+
+  const std::size_t nBlocks = points.intersections.size();
+
+  // the reference positions, stored contiguously
+  std::vector<ctype> xi(nPoints*mydim);
+  points.nPoints = nPoints;
+  points.weights.resize(nPoints);
+  for (unsigned int q = 0; q < nPoints; ++q)
+  {
+    points.weights[q] = quad[q].weight();
+    for (int k = 0; k < mydim; ++k)
+      xi[q*mydim+k] = quad[q].position()[k];
+  }
+
+  points.integrationElements.resize(nBlocks);
+  points.global.resize(nBlocks*nPoints);
+  points.inside.resize(nBlocks*nPoints);
+  points.outside.resize(nBlocks*nPoints);
+
+  // the blocks are independent of each other
+  Dune::GridGlue::parallelFor(nBlocks,
+                              Dune::GridGlue::Detail::QuadraturePointsChunk<Points, InsideView, OutsideView, IntersectionData>(intersections_, xi, points));
+}
+
+#endif // DUNE_GRIDGLUE_QUADRATUREPOINTS_HH
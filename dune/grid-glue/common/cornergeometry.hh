@@ -0,0 +1,121 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+/**
+   @file
+   @brief Lightweight geometry of a simplex or cube given by a pointer to its corners
+ */
+
+#ifndef DUNE_GRIDGLUE_CORNERGEOMETRY_HH
+#define DUNE_GRIDGLUE_CORNERGEOMETRY_HH
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/geometry/type.hh>
+
+namespace Dune {
+  namespace GridGlue {
+
+    /**
+       @brief Map local to global coordinates for a simplex or cube with stored corners
+
+       The geometry does not copy the corners, it only points to them, so it is
+       cheap to create and to copy.  The corners have to stay valid as long as the
+       geometry is used.  Simplices are mapped affinely, cubes multilinearly, with
+       the corners in the numbering of the Dune reference elements.
+
+       \tparam ctype the coordinate type
+       \tparam mydim the dimension of the geometry
+       \tparam coorddim the dimension of the global coordinates
+     */
+    template<class ctype, int mydim, int coorddim>
+    class CornerGeometry
+    {
+    public:
+
+      enum { mydimension = mydim };
+      enum { coorddimension = coorddim };
+
+      typedef Dune::FieldVector<ctype, mydim> LocalCoordinate;
+      typedef Dune::FieldVector<ctype, coorddim> GlobalCoordinate;
+
+      CornerGeometry()
+        : corners_(0), nCorners_(0)
+      {}
+
+      /**
+         @brief Construct from a geometry type and its corners
+         @param type a simplex or cube of dimension mydim
+         @param corners pointer to the first of the corners, which are stored consecutively
+       */
+      CornerGeometry(const Dune::GeometryType& type, const GlobalCoordinate* corners)
+        : type_(type), corners_(corners)
+      {
+        if (type.isSimplex())
+          nCorners_ = mydim + 1;
+        else if (type.isCube())
+          nCorners_ = 1 << mydim;
+        else
+          DUNE_THROW(Dune::NotImplemented, "CornerGeometry for geometry type " << type);
+      }
+
+      /** \brief The type of the geometry */
+      Dune::GeometryType type() const
+      {
+        return type_;
+      }
+
+      /** \brief Whether the mapping is affine */
+      bool affine() const
+      {
+        return type_.isSimplex() || mydim <= 1;
+      }
+
+      /** \brief The number of corners */
+      int corners() const
+      {
+        return nCorners_;
+      }
+
+      /** \brief The i'th corner */
+      const GlobalCoordinate& corner(int i) const
+      {
+        return corners_[i];
+      }
+
+      /** \brief Map a point from local to global coordinates */
+      GlobalCoordinate global(const LocalCoordinate& x) const
+      {
+        GlobalCoordinate y = corners_[0];
+
+        if (type_.isSimplex())
+        {
+          for (int k = 0; k < mydim; ++k)
+          {
+            y.axpy(x[k], corners_[k+1]);
+            y.axpy(-x[k], corners_[0]);
+          }
+          return y;
+        }
+
+        // multilinear interpolation, bit k of the corner number is its k'th coordinate
+        y = 0;
+        for (int i = 0; i < nCorners_; ++i)
+        {
+          ctype weight = 1;
+          for (int k = 0; k < mydim; ++k)
+            weight *= (i & (1 << k)) ? x[k] : 1 - x[k];
+          y.axpy(weight, corners_[i]);
+        }
+        return y;
+      }
+
+    private:
+      Dune::GeometryType type_;
+      const GlobalCoordinate* corners_;
+      int nCorners_;
+    };
+
+  } // end namespace GridGlue
+} // end namespace Dune
+
+#endif // DUNE_GRIDGLUE_CORNERGEOMETRY_HH
@@ -0,0 +1,128 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+/**
+   @file
+   @brief Simple loop parallelization over index ranges and GridGlue intersections
+ */
+
+#ifndef DUNE_GRIDGLUE_PARALLELFOR_HH
+#define DUNE_GRIDGLUE_PARALLELFOR_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+namespace Dune {
+  namespace GridGlue {
+
+    /** \brief Default number of consecutive indices handled by one thread at a time */
+    static const std::size_t defaultChunkSize = 256;
+
+    /**
+       @brief Call f(begin, end) for consecutive chunks [begin,end) covering [0,size)
+
+       The chunks are distributed over the OpenMP threads, if OpenMP is enabled.
+       Otherwise they are handled one after another.  Each chunk is a contiguous
+       index range, so data stored in index order is accessed sequentially by each
+       thread.  The chunks may be handled in any order and concurrently, hence
+       f has to be safe to call from several threads.
+
+       An exception must not leave an OpenMP thread.  With OpenMP, an exception
+       thrown by f is caught in its chunk, and the one of the first failed chunk
+       is thrown again as a Dune::Exception with the same message after the loop.
+
+       \param size the number of indices
+       \param f the functor to call on each chunk
+       \param chunkSize the maximum number of indices per chunk
+     */
+    template<class Functor>
+    void parallelFor(std::size_t size, const Functor& f, std::size_t chunkSize = defaultChunkSize)
+    {
+      if (chunkSize == 0)
+        chunkSize = 1;
+      const long nChunks = (size + chunkSize - 1) / chunkSize;
+
+#ifdef _OPENMP
+      std::vector<char> failed(nChunks, false);
+      std::vector<std::string> errors(nChunks);
+#pragma omp parallel for schedule(dynamic,1)
+      for (long c = 0; c < nChunks; ++c)
+      {
+        const std::size_t begin = c * chunkSize;
+        const std::size_t end = std::min(begin + chunkSize, size);
+        try
+        {
+          f(begin, end);
+        }
+        catch (Dune::Exception& e)
+        {
+          failed[c] = true;
+          errors[c] = e.what();
+        }
+        catch (std::exception& e)
+        {
+          failed[c] = true;
+          errors[c] = e.what();
+        }
+      }
+
+      for (long c = 0; c < nChunks; ++c)
+        if (failed[c])
+          DUNE_THROW(Dune::Exception, errors[c]);
+#else
+      for (long c = 0; c < nChunks; ++c)
+      {
+        const std::size_t begin = c * chunkSize;
+        const std::size_t end = std::min(begin + chunkSize, size);
+        f(begin, end);
+      }
+#endif
+    }
+
+    namespace Detail {
+
+      template<int I, class GlueType, class Functor>
+      struct IntersectionChunk
+      {
+        IntersectionChunk(const GlueType& glue, const Functor& f)
+          : glue_(glue), f_(f)
+        {}
+
+        void operator() (std::size_t begin, std::size_t end) const
+        {
+          for (std::size_t i = begin; i < end; ++i)
+            f_(glue_.template getIntersection<I>(i), i);
+        }
+
+        const GlueType& glue_;
+        const Functor& f_;
+      };
+
+    } // end namespace Detail
+
+    /**
+       @brief Call f(intersection, index) for all intersections of a GridGlue, in parallel
+
+       The intersections are seen from patch I, i.e. their inside entities belong to patch I.
+       Read-only access to the GridGlue is thread-safe, see GridGlue.  f has to be
+       safe to call from several threads.
+
+       \param glue the GridGlue
+       \param f the functor to call on each intersection
+       \param chunkSize the maximum number of consecutive intersections handled by one thread at a time
+     */
+    template<int I, class GlueType, class Functor>
+    void parallel_for_intersections(const GlueType& glue, const Functor& f,
+                                    std::size_t chunkSize = defaultChunkSize)
+    {
+      parallelFor(glue.size(), Detail::IntersectionChunk<I, GlueType, Functor>(glue, f), chunkSize);
+    }
+
+  } // end namespace GridGlue
+} // end namespace Dune
+
+#endif // DUNE_GRIDGLUE_PARALLELFOR_HH
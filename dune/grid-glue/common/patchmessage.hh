@@ -0,0 +1,187 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+/**
+   @file
+   @brief Packed message format for sending an extracted patch to another process
+ */
+
+#ifndef DUNE_GRIDGLUE_PATCHMESSAGE_HH
+#define DUNE_GRIDGLUE_PATCHMESSAGE_HH
+
+#include <cstring>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/geometry/type.hh>
+
+namespace Dune {
+  namespace GridGlue {
+
+    /**
+       @brief Serialize the coordinates, entities and geometry types of a patch into one buffer
+
+       The message consists of
+       - the number of coordinates, corner indices and entities, as variable-length integers
+       - the coordinates, stored as they are
+       - the corner indices, each stored as the zig-zag encoded difference to the
+         previous one in variable-length encoding.  Neighbouring entities mostly share
+         vertices, so most differences fit into a single byte.
+       - the geometry types, one byte each
+
+       A message can be unpacked on a machine with the same floating point representation.
+
+       \tparam ctype the coordinate type
+       \tparam dimworld the world dimension
+     */
+    template<class ctype, int dimworld>
+    class PatchMessage
+    {
+    public:
+
+      typedef Dune::FieldVector<ctype, dimworld> Coords;
+
+      /** \brief write a patch to buffer, replacing its contents */
+      static void pack(const std::vector<Coords>& coords,
+                       const std::vector<unsigned int>& entities,
+                       const std::vector<Dune::GeometryType>& types,
+                       std::vector<char>& buffer)
+      {
+        buffer.clear();
+        buffer.reserve(3*5 + coords.size()*sizeof(Coords) + entities.size() + types.size());
+
+        writeVarint(coords.size(), buffer);
+        writeVarint(entities.size(), buffer);
+        writeVarint(types.size(), buffer);
+
+        if (coords.size() > 0)
+        {
+          const std::size_t offset = buffer.size();
+          buffer.resize(offset + coords.size()*sizeof(Coords));
+          std::memcpy(&buffer[offset], &coords[0], coords.size()*sizeof(Coords));
+        }
+
+        unsigned int previous = 0;
+        for (std::size_t i = 0; i < entities.size(); ++i)
+        {
+          writeVarint(zigzag(entities[i], previous), buffer);
+          previous = entities[i];
+        }
+
+        for (std::size_t i = 0; i < types.size(); ++i)
+          buffer.push_back(encodeType(types[i]));
+      }
+
+      /** \brief read a patch written by pack() */
+      static void unpack(const std::vector<char>& buffer,
+                         std::vector<Coords>& coords,
+                         std::vector<unsigned int>& entities,
+                         std::vector<Dune::GeometryType>& types)
+      {
+        unpack(buffer.size() ? &buffer[0] : 0, buffer.size(), coords, entities, types);
+      }
+
+      /** \brief read a patch written by pack() from the size bytes at buffer */
+      static void unpack(const char* buffer, std::size_t size,
+                         std::vector<Coords>& coords,
+                         std::vector<unsigned int>& entities,
+                         std::vector<Dune::GeometryType>& types)
+      {
+        std::size_t pos = 0;
+
+        coords.resize(readVarint(buffer, size, pos));
+        entities.resize(readVarint(buffer, size, pos));
+        types.resize(readVarint(buffer, size, pos));
+
+        if (coords.size() > 0)
+        {
+          if (pos + coords.size()*sizeof(Coords) > size)
+            DUNE_THROW(Dune::Exception, "Truncated patch message");
+          std::memcpy(&coords[0], buffer + pos, coords.size()*sizeof(Coords));
+          pos += coords.size()*sizeof(Coords);
+        }
+
+        unsigned int previous = 0;
+        for (std::size_t i = 0; i < entities.size(); ++i)
+        {
+          previous = unzigzag(readVarint(buffer, size, pos), previous);
+          entities[i] = previous;
+        }
+
+        if (pos + types.size() > size)
+          DUNE_THROW(Dune::Exception, "Truncated patch message");
+        for (std::size_t i = 0; i < types.size(); ++i)
+          types[i] = decodeType(buffer[pos++]);
+      }
+
+    private:
+
+      static void writeVarint(unsigned long value, std::vector<char>& buffer)
+      {
+        while (value >= 0x80)
+        {
+          buffer.push_back(char((value & 0x7f) | 0x80));
+          value >>= 7;
+        }
+        buffer.push_back(char(value));
+      }
+
+      static unsigned long readVarint(const char* buffer, std::size_t size, std::size_t& pos)
+      {
+        unsigned long value = 0;
+        for (int shift = 0; ; shift += 7)
+        {
+          if (pos >= size)
+            DUNE_THROW(Dune::Exception, "Truncated patch message");
+          const unsigned char byte = buffer[pos++];
+          value |= (unsigned long)(byte & 0x7f) << shift;
+          if (!(byte & 0x80))
+            return value;
+        }
+      }
+
+      /** \brief map the difference value - previous to an unsigned number, small differences to small numbers */
+      static unsigned long zigzag(unsigned int value, unsigned int previous)
+      {
+        return (value >= previous) ? 2ul*(value - previous) : 2ul*(previous - value) - 1;
+      }
+
+      static unsigned int unzigzag(unsigned long code, unsigned int previous)
+      {
+        return (code % 2 == 0) ? previous + (unsigned int)(code / 2) : previous - (unsigned int)((code + 1) / 2);
+      }
+
+      /** \brief the dimension in the upper, the basic type in the lower four bits */
+      static char encodeType(const Dune::GeometryType& type)
+      {
+        int basicType;
+        if (type.isSimplex())
+          basicType = 0;
+        else if (type.isCube())
+          basicType = 1;
+        else if (type.isPyramid())
+          basicType = 2;
+        else if (type.isPrism())
+          basicType = 3;
+        else
+          DUNE_THROW(Dune::NotImplemented, "Geometry type " << type << " in patch message");
+        return char((type.dim() << 4) | basicType);
+      }
+
+      static Dune::GeometryType decodeType(char code)
+      {
+        static const Dune::GeometryType::BasicType basicTypes[4] = {
+          Dune::GeometryType::simplex, Dune::GeometryType::cube,
+          Dune::GeometryType::pyramid, Dune::GeometryType::prism
+        };
+        const unsigned int basicType = code & 0x0f;
+        if (basicType >= 4)
+          DUNE_THROW(Dune::Exception, "Invalid geometry type in patch message");
+        return Dune::GeometryType(basicTypes[basicType], (code >> 4) & 0x0f);
+      }
+    };
+
+  } // end namespace GridGlue
+} // end namespace Dune
+
+#endif // DUNE_GRIDGLUE_PATCHMESSAGE_HH
@@ -0,0 +1,86 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+/**
+   @file
+   @brief Keys along the Morton (Z-order) space-filling curve
+ */
+
+#ifndef DUNE_GRIDGLUE_SPACEFILLINGCURVE_HH
+#define DUNE_GRIDGLUE_SPACEFILLINGCURVE_HH
+
+#include <algorithm>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+
+namespace Dune {
+  namespace GridGlue {
+
+    /**
+       @brief Compute positions along the Morton curve for points in a bounding box
+
+       The bounding box is divided into 2^bits cells per direction, where
+       bits*dim does not exceed the 64 bits of the key.  Points that are close
+       to each other in space mostly get keys that are close to each other, so
+       sorting data by key improves the locality of the memory accesses.
+
+       \tparam ctype the coordinate type
+       \tparam dim the space dimension
+     */
+    template<class ctype, int dim>
+    class MortonCurve
+    {
+    public:
+
+      typedef unsigned long long Key;
+
+      typedef Dune::FieldVector<ctype, dim> Coordinate;
+
+      enum {
+        /** \brief bits per direction */
+        bits = (dim > 0) ? 63 / dim : 0
+      };
+
+      /** \brief Construct for the bounding box of a set of points */
+      MortonCurve(const std::vector<Coordinate>& points)
+      {
+        lower_ = upper_ = (points.empty() ? Coordinate(0) : points[0]);
+        for (std::size_t i = 1; i < points.size(); ++i)
+          for (int k = 0; k < dim; ++k)
+          {
+            lower_[k] = std::min(lower_[k], points[i][k]);
+            upper_[k] = std::max(upper_[k], points[i][k]);
+          }
+      }
+
+      /** \brief The position of x along the curve */
+      Key key(const Coordinate& x) const
+      {
+        const Key maxCell = (Key(1) << bits) - 1;
+
+        Key cell[dim > 0 ? dim : 1];
+        for (int k = 0; k < dim; ++k)
+        {
+          const ctype extent = upper_[k] - lower_[k];
+          const ctype t = (extent > 0) ? (x[k] - lower_[k]) / extent : ctype(0);
+          cell[k] = std::min(maxCell, Key(std::max(ctype(0), t) * maxCell));
+        }
+
+        // interleave the bits of the cell coordinates
+        Key result = 0;
+        for (int b = bits-1; b >= 0; --b)
+          for (int k = 0; k < dim; ++k)
+            result = (result << 1) | ((cell[k] >> b) & 1);
+
+        return result;
+      }
+
+    private:
+      Coordinate lower_;
+      Coordinate upper_;
+    };
+
+  } // end namespace GridGlue
+} // end namespace Dune
+
+#endif // DUNE_GRIDGLUE_SPACEFILLINGCURVE_HH
@@ -21,6 +21,7 @@
 
 #include <deque>
 
+#include <dune/common/typetraits.hh>
 #include <dune/grid/common/mcmgmapper.hh>
 
 #include "extractor.hh"
@@ -50,7 +51,9 @@ public:
   typedef typename Extractor<GV,0>::ElementInfo ElementInfo;
   typedef typename Extractor<GV,0>::VertexInfo VertexInfo;
   typedef typename Extractor<GV,0>::CoordinateInfo CoordinateInfo;
-  typedef typename Extractor<GV,0>::VertexInfoMap VertexInfoMap;
+  typedef typename Extractor<GV,0>::SubEntityKeys SubEntityKeys;
+  typedef typename Extractor<GV,0>::ExtractedChunk ExtractedChunk;
+  typedef typename Extractor<GV,0>::ElementSeed ElementSeed;
 
   /**
    * @brief Constructor
@@ -59,170 +62,366 @@ public:
   Codim0Extractor(const GV& gv, const ExtractorPredicate<GV,0>& descr)
     :  Extractor<GV,0>(gv), positiveNormalDirection_(false)
   {
-    std::cout << "This is Codim0Extractor on a <"
-              << GV::dimension << "," << GV::dimensionworld << "> grid!" << std::endl;
-    update(descr);
+    init(descr);
+  }
+
+  /**
+   * @brief Constructor taking any callable as predicate
+   * @param gv the grid view object to work with
+   * @param descr a callable with the signature bool(const Element&) that "selects" the elements to add to the patch
+   */
+  template<class Predicate>
+  Codim0Extractor(const GV& gv, const Predicate& descr,
+                  typename Dune::enable_if<!Dune::IsBaseOf<ExtractorPredicate<GV,0>, Predicate>::value, int>::type = 0)
+    :  Extractor<GV,0>(gv), positiveNormalDirection_(false)
+  {
+    init(descr);
   }
 
   bool & positiveNormalDirection() { return positiveNormalDirection_; }
   const bool & positiveNormalDirection() const { return positiveNormalDirection_; }
 
+  /**
+   * @brief (re-)extract the patch, e.g. after the grid has been adapted
+   * @param descr a predicate class that "selects" the elements to add to the patch
+   */
+  void update(const ExtractorPredicate<GV,0>& descr)
+  {
+    extract(PredicateSelector(descr));
+  }
+
+  /**
+   * @brief (re-)extract the patch, selecting the elements with any callable
+   *
+   * The callable is called directly, so it can be inlined.
+   * @param descr a callable with the signature bool(const Element&) that "selects" the elements to add to the patch
+   */
+  template<class Predicate>
+  typename Dune::enable_if<!Dune::IsBaseOf<ExtractorPredicate<GV,0>, Predicate>::value>::type
+  update(const Predicate& descr)
+  {
+    extract(descr);
+  }
+
+  /**
+   * @brief update the patch for a set of changed elements only
+   *
+   * The given elements are extracted again, all others are kept as they are.
+   * This covers elements that enter or leave the selection as well as moved
+   * elements, as long as the grid stays the same.  After the grid has been
+   * adapted, use update() without a change set; until then this method throws a
+   * Dune::InvalidStateException.  Modifications that keep the number of entities
+   * have to be announced by gridChanged().  The changes are reported by
+   * getChangedSubEntities() and getRemovedSubEntities().
+   * @param descr a predicate class that "selects" the elements to add to the patch
+   * @param changed the seeds of the changed elements
+   */
+  void update(const ExtractorPredicate<GV,0>& descr, const std::vector<ElementSeed>& changed)
+  {
+    extractElements(PredicateSelector(descr), changed);
+  }
+
+  /**
+   * @brief update the patch for a set of changed elements only, selecting the elements with any callable
+   * @param descr a callable with the signature bool(const Element&) that "selects" the elements to add to the patch
+   * @param changed the seeds of the changed elements
+   */
+  template<class Predicate>
+  typename Dune::enable_if<!Dune::IsBaseOf<ExtractorPredicate<GV,0>, Predicate>::value>::type
+  update(const Predicate& descr, const std::vector<ElementSeed>& changed)
+  {
+    extractElements(descr, changed);
+  }
+
 protected:
   bool positiveNormalDirection_;
+
 private:
-  void update(const ExtractorPredicate<GV,0>& descr);
+
+  /** \brief the common part of the constructors */
+  template<class Predicate>
+  void init(const Predicate& descr)
+  {
+    std::cout << "This is Codim0Extractor on a <"
+              << GV::dimension << "," << GV::dimensionworld << "> grid!" << std::endl;
+    update(descr);
+  }
+
+  /** \brief select the elements with a virtual predicate */
+  struct PredicateSelector
+  {
+    PredicateSelector(const ExtractorPredicate<GV,0>& descr) : descr_(descr) {}
+
+    bool operator() (const ElementPtr& element) const
+    {
+      return descr_.contains(element, 0);
+    }
+
+    const ExtractorPredicate<GV,0>& descr_;
+  };
+
+  /** \brief call a predicate on the element, either directly or through PredicateSelector */
+  static bool select(const PredicateSelector& descr, const ElementPtr& element)
+  {
+    return descr(element);
+  }
+
+  template<class Predicate>
+  static bool select(const Predicate& descr, const ElementPtr& element)
+  {
+    return descr(*element);
+  }
+
+  /** \brief extract the elements selected by descr */
+  template<class Selector>
+  void extract(const Selector& descr);
+
+  /** \brief extract the given elements again and keep the rest of the patch */
+  template<class Selector>
+  void extractElements(const Selector& descr, const std::vector<ElementSeed>& changed);
+
+  /** \brief extract the elements of a range of chunks, on one thread */
+  template<class Selector>
+  struct ChunkExtractor
+  {
+    ChunkExtractor(const Codim0Extractor& extractor, const Selector& descr,
+                   const std::vector<ElementSeed>& elements, std::vector<ExtractedChunk>& chunks,
+                   std::size_t chunkSize)
+      : extractor_(extractor), descr_(descr), elements_(elements), chunks_(chunks), chunkSize_(chunkSize)
+    {}
+
+    void operator() (std::size_t begin, std::size_t end) const
+    {
+      ExtractedChunk& chunk = chunks_[begin / chunkSize_];
+      size_t element_index = 0;
+      try
+      {
+        for (std::size_t i = begin; i < end; ++i)
+          extractor_.addElement(extractor_.gv_.grid().entityPointer(elements_[i]), descr_,
+                                chunk, element_index, chunk.faces);
+      }
+      catch (Dune::Exception& e)
+      {
+        chunk.error = e.what();
+      }
+      catch (std::exception& e)
+      {
+        chunk.error = e.what();
+      }
+      chunk.nFaces = element_index;
+    }
+
+    const Codim0Extractor& extractor_;
+    const Selector& descr_;
+    const std::vector<ElementSeed>& elements_;
+    std::vector<ExtractedChunk>& chunks_;
+    const std::size_t chunkSize_;
+  };
+
+  /**
+   * \brief extract one element if the predicate selects it
+   * \param sink the extractor itself or a chunk, which gets the vertices and the element
+   */
+  template<class Selector, class Sink>
+  void addElement(const ElementPtr& eptr, const Selector& descr,
+                  Sink& sink, size_t& element_index, std::deque<SubEntityInfo>& temp_faces) const;
 };
 
 
 template<typename GV>
-void Codim0Extractor<GV>::update(const ExtractorPredicate<GV,0>& descr)
+template<class Selector>
+void Codim0Extractor<GV>::extract(const Selector& descr)
 {
   // In this first pass iterate over all entities of codim 0.
   // Get its corner vertices, find resp. store them together with their associated index,
   // and remember the indices of the corners.
 
+  // remember the previous extraction to be able to report changes
+  SubEntityKeys previousKeys;
+  previousKeys.swap(this->subEntityKeys_);
+
   // free everything there is in this object
   this->clear();
 
+  // the grid may have changed since the last call
+  this->cellMapper_.update();
+  this->resetIndexTables();
+
   // several counter for consecutive indexing are needed
   size_t element_index = 0;
-  size_t vertex_index = 0;
 
   // a temporary container where newly acquired face
   // information can be stored at first
   std::deque<SubEntityInfo> temp_faces;
 
-  // iterate over all codim 0 elements on the grid
-  for (ElementIter elit = this->gv_.template begin<0>(); elit != this->gv_.template end<0>(); ++elit)
+  if (this->parallelExtraction_)
   {
-    ElementPtr eptr(elit);
-    IndexType eindex = this->cellMapper_.map(*elit);
+    // extract chunks of elements on several threads...
+    std::vector<ElementSeed> elements;
+    for (ElementIter elit = this->gv_.template begin<0>(); elit != this->gv_.template end<0>(); ++elit)
+      elements.push_back(elit->seed());
 
-    // only do sth. if this element is "interesting"
-    // implicit cast is done automatically
-    if (descr.contains(eptr,0))
+    const std::size_t chunkSize = Dune::GridGlue::defaultChunkSize;
+    std::vector<ExtractedChunk> chunks((elements.size() + chunkSize - 1) / chunkSize);
+    Dune::GridGlue::parallelFor(elements.size(), ChunkExtractor<Selector>(*this, descr, elements, chunks, chunkSize), chunkSize);
+    this->checkChunks(chunks);
+
+    // ...and put them together in element order
+    for (std::size_t c = 0; c < chunks.size(); ++c)
     {
-      // add an entry to the element info map, the index will be set properly later
-      this->elmtInfo_[eindex] = new ElementInfo(element_index, eptr, 1);
+      this->appendChunk(chunks[c], temp_faces);
+      chunks[c] = ExtractedChunk();
+    }
+    element_index = temp_faces.size();
+    this->computeCoordinates();
+  }
+  else
+  {
+    // iterate over all codim 0 elements on the grid
+    for (ElementIter elit = this->gv_.template begin<0>(); elit != this->gv_.template end<0>(); ++elit)
+      addElement(ElementPtr(elit), descr, *this, element_index, temp_faces);
+  }
 
-      int numCorners = elit->template count<dim>();
-      unsigned int vertex_indices[numCorners];       // index in global vector
-      unsigned int vertex_numbers[numCorners];       // index in parent entity
+  // allocate the array for the face specific information...
+  this->subEntities_.resize(element_index);
+  // ...and fill in the data from the temporary containers
+  copy(temp_faces.begin(), temp_faces.end(), this->subEntities_.begin());
 
-      // try for each of the faces vertices whether it is already inserted or not
-      for (int i = 0; i < numCorners; ++i)
-      {
-        vertex_numbers[i] = i;
+  // number the vertices and subentities along a space-filling curve
+  if (this->spatialOrdering_)
+    this->reorderSpatially();
 
-        // get the vertex pointer and the index from the index set
-        VertexPtr vptr(elit->template subEntity<dim>(vertex_numbers[i]));
-        IndexType vindex = this->gv_.indexSet().template index<dim>(*vptr);
+  // the corners of each subentity, for fast geometry access
+  this->computeCornerTables();
+
+  // match the new subentities against the previous ones
+  this->computeChanges(previousKeys);
+}
+
+
+template<typename GV>
+template<class Selector>
+void Codim0Extractor<GV>::extractElements(const Selector& descr, const std::vector<ElementSeed>& changed)
+{
+  // single elements can only be extracted again as long as the grid is the same
+  this->checkIndexTables();
+
+  // take the changed elements out of the patch...
+  std::vector<char> removed(this->subEntities_.size(), 0);
+  for (typename std::vector<ElementSeed>::const_iterator it = changed.begin(); it != changed.end(); ++it)
+    this->detachElement(this->cellMapper_.map(*this->gv_.grid().entityPointer(*it)), removed);
+
+  // ...and extract them again, their subentities are numbered after the previous ones
+  size_t element_index = this->subEntities_.size();
+  std::deque<SubEntityInfo> temp_faces;
+  for (typename std::vector<ElementSeed>::const_iterator it = changed.begin(); it != changed.end(); ++it)
+  {
+    const ElementPtr eptr = this->gv_.grid().entityPointer(*it);
+    // an element given twice is only added once
+    if (this->elementTable_[this->cellMapper_.map(*eptr)] < 0)
+      addElement(eptr, descr, *this, element_index, temp_faces);
+  }
+
+  this->finishIncrementalUpdate(removed, temp_faces);
+}
 
-        // if the vertex is not yet inserted in the vertex info map
-        // it is a new one -> it will be inserted now!
-        typename VertexInfoMap::iterator vimit = this->vtxInfo_.find(vindex);
-        if (vimit == this->vtxInfo_.end())
-        {
-          // insert into the map
-          this->vtxInfo_[vindex] = new VertexInfo(vertex_index, vptr);
-          // remember this vertex' index
-          vertex_indices[i] = vertex_index;
-          // increase the current index
-          vertex_index++;
-        }
-        else
-        {
-          // only remember the vertex' index
-          vertex_indices[i] = vimit->second->idx;
-        }
-      }
 
-      // flip cell if necessary
+template<typename GV>
+template<class Selector, class Sink>
+void Codim0Extractor<GV>::addElement(const ElementPtr& eptr, const Selector& descr,
+                                     Sink& sink, size_t& element_index,
+                                     std::deque<SubEntityInfo>& temp_faces) const
+{
+  IndexType eindex = this->cellMapper_.map(*eptr);
+
+  // only do sth. if this element is "interesting"
+  // implicit cast is done automatically
+  if (select(descr, eptr))
+  {
+    // add an entry to the element table
+    sink.insertElement(eptr, eindex, element_index).faces = 1;
+
+    int numCorners = eptr->template count<dim>();
+    unsigned int vertex_indices[numCorners];       // index in global vector
+    unsigned int vertex_numbers[numCorners];       // index in parent entity
+
+    // try for each of the faces vertices whether it is already inserted or not
+    for (int i = 0; i < numCorners; ++i)
+    {
+      vertex_numbers[i] = i;
+
+      // get the vertex pointer and the index from the index set
+      VertexPtr vptr(eptr->template subEntity<dim>(vertex_numbers[i]));
+      IndexType vindex = this->gv_.indexSet().template index<dim>(*vptr);
+
+      // add the vertex to the patch unless it is contained already,
+      // and remember its index
+      vertex_indices[i] = sink.insertVertex(vptr, vindex);
+    }
+
+    // flip cell if necessary
+    {
+      switch (int(dim))
       {
-        switch (int(dim))
-        {
-        case 0 :
-          break;
-        case 1 :
+      case 0 :
+        break;
+      case 1 :
+      {
+        // The following test only works if the zero-th coordinate is the
+        // one that defines the orientation.  A sufficient condition for
+        // this is dimworld == 1
+        /* assert(dimworld==1); */
+        bool elementNormalDirection =
+          (eptr->geometry().corner(1)[0] < eptr->geometry().corner(0)[0]);
+        if ( positiveNormalDirection_ != elementNormalDirection )
         {
-          // The following test only works if the zero-th coordinate is the
-          // one that defines the orientation.  A sufficient condition for
-          // this is dimworld == 1
-          /* assert(dimworld==1); */
-          bool elementNormalDirection =
-            (elit->geometry().corner(1)[0] < elit->geometry().corner(0)[0]);
-          if ( positiveNormalDirection_ != elementNormalDirection )
-          {
-            std::swap(vertex_indices[0], vertex_indices[1]);
-            std::swap(vertex_numbers[0], vertex_numbers[1]);
-          }
-          break;
+          std::swap(vertex_indices[0], vertex_indices[1]);
+          std::swap(vertex_numbers[0], vertex_numbers[1]);
         }
-        case 2 :
+        break;
+      }
+      case 2 :
+      {
+        Dune::FieldVector<ctype, dimworld>
+        v0 = eptr->geometry().corner(1),
+          v1 = eptr->geometry().corner(2);
+        v0 -= eptr->geometry().corner(0);
+        v1 -= eptr->geometry().corner(0);
+        ctype normal_sign = v0[0]*v1[1] - v0[1]*v1[0];
+        bool elementNormalDirection = (normal_sign < 0);
+        if ( positiveNormalDirection_ != elementNormalDirection )
         {
-          Dune::FieldVector<ctype, dimworld>
-          v0 = elit->geometry().corner(1),
-            v1 = elit->geometry().corner(2);
-          v0 -= elit->geometry().corner(0);
-          v1 -= elit->geometry().corner(0);
-          ctype normal_sign = v0[0]*v1[1] - v0[1]*v1[0];
-          bool elementNormalDirection = (normal_sign < 0);
-          if ( positiveNormalDirection_ != elementNormalDirection )
+          std::cout << "swap\n";
+          if (eptr->type().isCube())
           {
-            std::cout << "swap\n";
-            if (elit->type().isCube())
+            for (int i = 0; i < (1<<dim); i+=2)
             {
-              for (int i = 0; i < (1<<dim); i+=2)
-              {
-                // swap i and i+1
-                std::swap(vertex_indices[i], vertex_indices[i+1]);
-                std::swap(vertex_numbers[i], vertex_numbers[i+1]);
-              }
-            } else if (elit->type().isSimplex()) {
-              std::swap(vertex_indices[0], vertex_indices[1]);
-              std::swap(vertex_numbers[0], vertex_numbers[1]);
-            } else {
-              DUNE_THROW(Dune::Exception, "Unexpected Geometrytype");
+              // swap i and i+1
+              std::swap(vertex_indices[i], vertex_indices[i+1]);
+              std::swap(vertex_numbers[i], vertex_numbers[i+1]);
             }
+          } else if (eptr->type().isSimplex()) {
+            std::swap(vertex_indices[0], vertex_indices[1]);
+            std::swap(vertex_numbers[0], vertex_numbers[1]);
+          } else {
+            DUNE_THROW(Dune::Exception, "Unexpected Geometrytype");
           }
-          break;
-        }
         }
+        break;
       }
-
-      // add a new face to the temporary collection
-      temp_faces.push_back(SubEntityInfo(eindex,0,elit->type()));
-      element_index++;
-      for (int i=0; i<numCorners; i++) {
-        temp_faces.back().corners[i].idx = vertex_indices[i];
-        // remember the vertices' numbers in parent element's vertices
-        temp_faces.back().corners[i].num = vertex_numbers[i];
       }
-
     }
-  }   // end loop over elements
 
-  // allocate the array for the face specific information...
-  this->subEntities_.resize(element_index);
-  // ...and fill in the data from the temporary containers
-  copy(temp_faces.begin(), temp_faces.end(), this->subEntities_.begin());
+    // add a new face to the temporary collection
+    temp_faces.push_back(SubEntityInfo(eindex,0,eptr->type()));
+    element_index++;
+    for (int i=0; i<numCorners; i++) {
+      temp_faces.back().corners[i].idx = vertex_indices[i];
+      // remember the vertices' numbers in parent element's vertices
+      temp_faces.back().corners[i].num = vertex_numbers[i];
+    }
 
-  // now first write the array with the coordinates...
-  this->coords_.resize(this->vtxInfo_.size());
-  typename VertexInfoMap::const_iterator it1 = this->vtxInfo_.begin();
-  for (; it1 != this->vtxInfo_.end(); ++it1)
-  {
-    // get a pointer to the associated info object
-    CoordinateInfo* current = &this->coords_[it1->second->idx];
-    // store this coordinates index // NEEDED?
-    current->index = it1->second->idx;
-    // store the vertex' index for the index2vertex mapping
-    current->vtxindex = it1->first;
-    // store the vertex' coordinates under the associated index
-    // in the coordinates array
-    current->coord = it1->second->p->geometry().corner(0);
   }
-
 }
 
 #endif // DUNE_CODIM_0_EXTRACTOR_HH
@@ -19,7 +19,9 @@
 #ifndef DUNE_CODIM_1_EXTRACTOR_HH
 #define DUNE_CODIM_1_EXTRACTOR_HH
 
-#include <set>
+#include <vector>
+
+#include <dune/common/typetraits.hh>
 
 #include "extractor.hh"
 #include "extractorpredicate.hh"
@@ -58,13 +60,17 @@ public:
   typedef typename GV::Traits::template Codim<0>::Iterator ElementIter;
 
   typedef typename GV::IntersectionIterator IsIter;
+  typedef typename GV::Intersection Intersection;
+  typedef typename Extractor<GV,1>::ElementSeed ElementSeed;
+  typedef typename Extractor<GV,1>::ExtractedChunk ExtractedChunk;
 
   // import typedefs from base class
   typedef typename Extractor<GV,1>::SubEntityInfo SubEntityInfo;
   typedef typename Extractor<GV,1>::ElementInfo ElementInfo;
   typedef typename Extractor<GV,1>::VertexInfo VertexInfo;
   typedef typename Extractor<GV,1>::CoordinateInfo CoordinateInfo;
-  typedef typename Extractor<GV,1>::VertexInfoMap VertexInfoMap;
+  typedef typename Extractor<GV,1>::SubEntityKeys SubEntityKeys;
+  typedef typename Extractor<GV,1>::GridKey GridKey;
 
 public:
 
@@ -75,15 +81,35 @@ public:
    * @param gv the grid view object to work with
    */
   Codim1Extractor(const GV& gv, const ExtractorPredicate<GV,1>& descr)
-    :  Extractor<GV,1>(gv)
+    :  Extractor<GV,1>(gv), keepQuadrilaterals_(false), boundaryTraversal_(false)
   {
-    std::cout << "This is Codim1Extractor on a <" << dim
-              << "," << dimworld << "> grid!"
-              << std::endl;
-    update(descr);
+    init(descr);
   }
 
-private:
+  /**
+   * @brief Constructor taking any callable as predicate
+   * @param gv the grid view object to work with
+   * @param descr a callable with the signature bool(const Element&, const Intersection&),
+   * called for the boundary intersections, that "selects" the faces to add to the surface
+   */
+  template<class Predicate>
+  Codim1Extractor(const GV& gv, const Predicate& descr,
+                  typename Dune::enable_if<!Dune::IsBaseOf<ExtractorPredicate<GV,1>, Predicate>::value, int>::type = 0)
+    :  Extractor<GV,1>(gv), keepQuadrilaterals_(false), boundaryTraversal_(false)
+  {
+    init(descr);
+  }
+
+  /**
+   * @brief Constructor extracting the boundary faces with the given boundary ids
+   * @param gv the grid view object to work with
+   * @param descr the boundary ids of the faces to extract
+   */
+  Codim1Extractor(const GV& gv, const BoundaryIdPredicate& descr)
+    :  Extractor<GV,1>(gv), keepQuadrilaterals_(false), boundaryTraversal_(false)
+  {
+    init(descr);
+  }
 
   /**
    * Extracts a codimension 1 surface from the grid @c g and builds up two arrays
@@ -96,241 +122,314 @@ private:
    * index 1 is associated with the position x1. If the surface consists of triangles
    * we have always groups of 3 indices describing one triangle.
    *
+   * The method can be called again to re-extract the surface, e.g. after the grid
+   * has been adapted.
+   *
    * @param descr a predicate class that "selects" the faces to add to the surface
    */
   void update(const ExtractorPredicate<GV,1>& descr);
 
+  /**
+   * @brief (re-)extract the boundary faces with the given boundary ids
+   *
+   * Same as the update() taking a predicate, but the boundary ids are
+   * checked directly on the intersections, without a virtual call.
+   */
+  void update(const BoundaryIdPredicate& descr);
+
+  /**
+   * @brief (re-)extract the surface, selecting the faces with any callable
+   *
+   * The callable is called directly on the boundary intersections, so it can be
+   * inlined and does not have to look up the intersection again.
+   * @param descr a callable with the signature bool(const Element&, const Intersection&)
+   */
+  template<class Predicate>
+  typename Dune::enable_if<!Dune::IsBaseOf<ExtractorPredicate<GV,1>, Predicate>::value>::type
+  update(const Predicate& descr)
+  {
+    extract(CallableSelector<Predicate>(descr));
+  }
+
+  /**
+   * @brief update the surface for a set of changed elements only
+   *
+   * The faces of the given elements are extracted again, all other faces are
+   * kept as they are.  This covers faces that enter or leave the selection as
+   * well as moved elements, as long as the grid stays the same.  After the grid
+   * has been adapted, use update() without a change set; until then this method
+   * throws a Dune::InvalidStateException.  Modifications that keep the number of
+   * entities have to be announced by gridChanged().  Changed elements at the
+   * boundary are added to the ones visited by the boundary traversal.  The changes
+   * are reported by getChangedSubEntities() and getRemovedSubEntities().
+   * @param descr a predicate class that "selects" the faces to add to the surface
+   * @param changed the seeds of the changed elements
+   */
+  void update(const ExtractorPredicate<GV,1>& descr, const std::vector<ElementSeed>& changed)
+  {
+    extractElements(PredicateSelector(descr), changed);
+  }
+
+  /** @brief update the boundary faces with the given boundary ids for a set of changed elements only */
+  void update(const BoundaryIdPredicate& descr, const std::vector<ElementSeed>& changed)
+  {
+    extractElements(BoundaryIdSelector(descr), changed);
+  }
+
+  /**
+   * @brief update the surface for a set of changed elements only, selecting the faces with any callable
+   * @param descr a callable with the signature bool(const Element&, const Intersection&)
+   * @param changed the seeds of the changed elements
+   */
+  template<class Predicate>
+  typename Dune::enable_if<!Dune::IsBaseOf<ExtractorPredicate<GV,1>, Predicate>::value>::type
+  update(const Predicate& descr, const std::vector<ElementSeed>& changed)
+  {
+    extractElements(CallableSelector<Predicate>(descr), changed);
+  }
+
+  /**
+   * @brief extract quadrilateral faces as they are instead of splitting them into two triangles
+   *
+   * If set, subsequent updates add each quadrilateral boundary face as one
+   * subentity of GeometryType cube, so the patch has as many faces as the grid
+   * boundary.  The mergers for surfaces, PSurfaceMerge and ConformingMerge,
+   * accept quadrilaterals.  The remote intersections are still simplices.
+   */
+  bool & keepQuadrilaterals() { return keepQuadrilaterals_; }
+  const bool & keepQuadrilaterals() const { return keepQuadrilaterals_; }
+
+  /**
+   * @brief only visit the elements at the domain boundary in subsequent updates
+   *
+   * If set, the next update() remembers the elements with at least one boundary
+   * intersection, and later updates only visit these elements instead of the
+   * whole grid view.  The list is collected again when the number of entities
+   * of the grid view has changed or gridChanged() has been called, which has to
+   * be done after any other modification of the grid.
+   */
+  bool & boundaryTraversal() { return boundaryTraversal_; }
+  const bool & boundaryTraversal() const { return boundaryTraversal_; }
+
+  /**
+   * @brief forget the elements at the domain boundary, the next update() visits the whole grid view
+   */
+  void resetBoundaryElements()
+  {
+    std::vector<ElementSeed>().swap(boundaryElements_);
+    std::vector<char>().swap(isBoundaryElement_);
+    boundaryElementsKey_ = GridKey();
+  }
+
+private:
+
+  /** \brief the common part of the constructors */
+  template<class Predicate>
+  void init(const Predicate& descr)
+  {
+    std::cout << "This is Codim1Extractor on a <" << dim
+              << "," << dimworld << "> grid!"
+              << std::endl;
+    update(descr);
+  }
+
+  /** \brief select the faces with a virtual predicate */
+  struct PredicateSelector
+  {
+    PredicateSelector(const ExtractorPredicate<GV,1>& descr) : descr_(descr) {}
+
+    bool operator() (const ElementPtr& element, const Intersection& is) const
+    {
+      return descr_.contains(element, is.indexInInside());
+    }
+
+    const ExtractorPredicate<GV,1>& descr_;
+  };
+
+  /** \brief select the faces by their boundary id */
+  struct BoundaryIdSelector
+  {
+    BoundaryIdSelector(const BoundaryIdPredicate& descr) : descr_(descr) {}
+
+    bool operator() (const ElementPtr& element, const Intersection& is) const
+    {
+      return descr_(is);
+    }
+
+    const BoundaryIdPredicate& descr_;
+  };
+
+  /** \brief select the faces with a callable taking the element and the intersection */
+  template<class Predicate>
+  struct CallableSelector
+  {
+    CallableSelector(const Predicate& descr) : descr_(descr) {}
+
+    bool operator() (const ElementPtr& element, const Intersection& is) const
+    {
+      return descr_(*element, is);
+    }
+
+    const Predicate& descr_;
+  };
+
+  /** \brief extract the faces chosen by select */
+  template<class Selector>
+  void extract(const Selector& select);
+
+  /** \brief extract the faces of the given elements again and keep the rest of the surface */
+  template<class Selector>
+  void extractElements(const Selector& select, const std::vector<ElementSeed>& changed);
+
+  /** \brief extract the faces chosen by select in chunks on several threads */
+  template<class Selector>
+  void extractParallel(const Selector& select, int& simplex_index, std::deque<SubEntityInfo>& temp_faces);
+
+  /** \brief extract the elements of a range of chunks, on one thread */
+  template<class Selector>
+  struct ChunkExtractor
+  {
+    ChunkExtractor(const Codim1Extractor& extractor, const Selector& select,
+                   const std::vector<ElementSeed>& elements, std::vector<ExtractedChunk>& chunks,
+                   std::vector<char>& atBoundary, std::size_t chunkSize)
+      : extractor_(extractor), select_(select), elements_(elements), chunks_(chunks),
+        atBoundary_(atBoundary), chunkSize_(chunkSize)
+    {}
+
+    void operator() (std::size_t begin, std::size_t end) const
+    {
+      ExtractedChunk& chunk = chunks_[begin / chunkSize_];
+      try
+      {
+        for (std::size_t i = begin; i < end; ++i)
+          atBoundary_[i] = extractor_.addFaces(extractor_.gv_.grid().entityPointer(elements_[i]), select_,
+                                               chunk, chunk.nFaces, chunk.faces);
+      }
+      catch (Dune::Exception& e)
+      {
+        chunk.error = e.what();
+      }
+      catch (std::exception& e)
+      {
+        chunk.error = e.what();
+      }
+    }
+
+    const Codim1Extractor& extractor_;
+    const Selector& select_;
+    const std::vector<ElementSeed>& elements_;
+    std::vector<ExtractedChunk>& chunks_;
+    std::vector<char>& atBoundary_;
+    const std::size_t chunkSize_;
+  };
+
+  /**
+   * \brief add the chosen boundary faces of one element to temp_faces
+   * \param sink the extractor itself or a chunk, which gets the vertices and the element
+   * \return whether the element has boundary intersections at all
+   */
+  template<class Selector, class Sink>
+  bool addFaces(const ElementPtr& eptr, const Selector& select, Sink& sink,
+                int& simplex_index, std::deque<SubEntityInfo>& temp_faces) const;
+
+  /// @brief whether quadrilateral faces are extracted without splitting them
+  bool keepQuadrilaterals_;
+
+  /// @brief whether update() only visits the elements in boundaryElements_
+  bool boundaryTraversal_;
+
+  /** @brief add an element to boundaryElements_ unless it is contained already */
+  void insertBoundaryElement(const ElementSeed& seed, IndexType eindex)
+  {
+    if (isBoundaryElement_[eindex])
+      return;
+    isBoundaryElement_[eindex] = true;
+    boundaryElements_.push_back(seed);
+  }
+
+  /// @brief the elements with boundary intersections
+  std::vector<ElementSeed> boundaryElements_;
+
+  /// @brief whether an element is contained in boundaryElements_, by the index of cellMapper_
+  std::vector<char> isBoundaryElement_;
+
+  /// @brief the state of the grid view when boundaryElements_ was collected, invalid if it has not been
+  GridKey boundaryElementsKey_;
+
 };
 
 
 template<typename GV>
 void Codim1Extractor<GV>::update(const ExtractorPredicate<GV,1>& descr)
 {
+  extract(PredicateSelector(descr));
+}
+
+
+template<typename GV>
+void Codim1Extractor<GV>::update(const BoundaryIdPredicate& descr)
+{
+  extract(BoundaryIdSelector(descr));
+}
+
+
+template<typename GV>
+template<class Selector>
+void Codim1Extractor<GV>::extract(const Selector& select)
+{
+  // remember the previous extraction to be able to report changes
+  SubEntityKeys previousKeys;
+  previousKeys.swap(this->subEntityKeys_);
+
   // free everything there is in this object
   this->clear();
 
-  // In this first pass iterate over all entities of codim 0.
+  // the grid may have changed since the last call
+  this->cellMapper_.update();
+  this->resetIndexTables();
+
+  // the cached boundary elements are only valid for the grid they were collected on
+  if (boundaryElementsKey_ != this->gridKey())
+    resetBoundaryElements();
+
+  // In this first pass iterate over all entities of codim 0, or over the ones
+  // at the boundary if they are known.
   // For each codim 1 intersection check if it is part of the boundary and if so,
   // get its corner vertices, find resp. store them together with their associated index,
   // and remember the indices of the boundary faces' corners.
   {
     // several counter for consecutive indexing are needed
     int simplex_index = 0;
-    int vertex_index = 0;
-    IndexType eindex = 0;     // supress warning
-
-    // needed later for insertion into a std::set which only
-    // works with const references
 
     // a temporary container where newly acquired face
     // information can be stored at first
     std::deque<SubEntityInfo> temp_faces;
 
-    // iterate over all codim 0 elements on the grid
-    for (ElementIter elit = this->gv_.template begin<0>(); elit != this->gv_.template end<0>(); ++elit)
+    if (this->parallelExtraction_)
+      extractParallel(select, simplex_index, temp_faces);
+    else if (boundaryTraversal_ && boundaryElementsKey_.valid())
     {
-      ElementPtr eptr(elit);
-      Dune::GeometryType gt = elit->type();
-
-      // remember the indices of the faces that shall become
-      // part of the surface
-      std::set<int> boundary_faces;
+      // only visit the elements known to be at the boundary
+      for (typename std::vector<ElementSeed>::const_iterator it = boundaryElements_.begin();
+           it != boundaryElements_.end(); ++it)
+        addFaces(this->gv_.grid().entityPointer(*it), select, *this, simplex_index, temp_faces);
+    }
+    else
+    {
+      if (boundaryTraversal_)
+        isBoundaryElement_.assign(this->cellMapper_.size(), false);
 
-      // iterate over all intersections of codim 1 and test if the
-      // boundary intersections are to be added to the surface
-      for (IsIter is = this->gv_.ibegin(*elit); is != this->gv_.iend(*elit); ++is)
+      // iterate over all codim 0 elements on the grid
+      for (ElementIter elit = this->gv_.template begin<0>(); elit != this->gv_.template end<0>(); ++elit)
       {
-        // only look at boundary faces
-        if (is->boundary() && descr.contains(eptr, is->indexInInside()))
-          boundary_faces.insert(is->indexInInside());
+        const ElementPtr eptr(elit);
+        if (addFaces(eptr, select, *this, simplex_index, temp_faces) && boundaryTraversal_)
+          insertBoundaryElement(elit->seed(), this->cellMapper_.map(*elit));
       }
 
-      // if some face is part of the surface add it!
-      if (boundary_faces.size() != 0)
-      {
-        // add an entry to the element info map, the index will be set properly later,
-        // whereas the number of faces is already known
-        eindex = this->cellMapper_.map(*elit);
-        this->elmtInfo_[eindex] = new ElementInfo(simplex_index, eptr, 0);
-
-        // now add the faces in ascending order of their indices
-        // (we are only talking about 1-4 faces here, so O(n^2) is ok!)
-        for (typename std::set<int>::const_iterator sit = boundary_faces.begin(); sit != boundary_faces.end(); ++sit)
-        {
-          // get the corner count of this face
-          const int face_corners = Dune::GenericReferenceElements<ctype, dim>::general(gt).size(*sit, 1, dim);
-
-
-          // now we only have to care about the 3D case, i.e. a triangle face can be
-          // inserted directly whereas a quadrilateral face has to be divided into two triangles
-          switch (face_corners)
-          {
-          case 2 :
-            assert(dim == 2);
-            // we have a line here
-
-            // register the additional face(s)
-            this->elmtInfo_[eindex]->faces++;
-
-            // add a new face to the temporary collection
-            temp_faces.push_back(SubEntityInfo(eindex, *sit,
-                                               Dune::GeometryType(Dune::GeometryType::simplex,dim-codim)));
-
-            // try for each of the faces vertices whether it is already inserted or not
-            for (int i = 0; i < face_corners; ++i)
-            {
-              // get the number of the vertex in the parent element
-              int vertex_number = orientedSubface<2>(gt, *sit, i);
-
-              // get the vertex pointer and the index from the index set
-              VertexPtr vptr(elit->template subEntity<dim>(vertex_number));
-              IndexType vindex = this->gv_.indexSet().template index<dim>(*vptr);
-
-              // remember the vertex' number in parent element's vertices
-              temp_faces.back().corners[i].num = vertex_number;
-
-              // if the vertex is not yet inserted in the vertex info map
-              // it is a new one -> it will be inserted now!
-              typename VertexInfoMap::iterator vimit = this->vtxInfo_.find(vindex);
-              if (vimit == this->vtxInfo_.end())
-              {
-                // insert into the map
-                this->vtxInfo_[vindex] = new VertexInfo(vertex_index, vptr);
-                // remember the vertex as a corner of the current face in temp_faces
-                temp_faces.back().corners[i].idx = vertex_index;
-                // increase the current index
-                vertex_index++;
-              }
-              else
-              {
-                // only insert the index into the simplices array
-                temp_faces.back().corners[i].idx = vimit->second->idx;
-              }
-            }
-
-            // now increase the current face index
-            simplex_index++;
-            break;
-          case 3 :
-            assert(dim == 3);
-            // we have a triangle here
-
-            // register the additional face(s)
-            this->elmtInfo_[eindex]->faces++;
-
-            // add a new face to the temporary collection
-            temp_faces.push_back(SubEntityInfo(eindex, *sit,
-                                               Dune::GeometryType(Dune::GeometryType::simplex,dim-codim)));
-
-            // try for each of the faces vertices whether it is already inserted or not
-            for (int i = 0; i < simplex_corners; ++i)
-            {
-              // get the number of the vertex in the parent element
-              int vertex_number = orientedSubface<dim>(gt, *sit, i);
-
-              // get the vertex pointer and the index from the index set
-              VertexPtr vptr(elit->template subEntity<dim>(vertex_number));
-              IndexType vindex = this->gv_.indexSet().template index<dim>(*vptr);
-
-              // remember the vertex' number in parent element's vertices
-              temp_faces.back().corners[i].num = vertex_number;
-
-              // if the vertex is not yet inserted in the vertex info map
-              // it is a new one -> it will be inserted now!
-              typename VertexInfoMap::iterator vimit = this->vtxInfo_.find(vindex);
-              if (vimit == this->vtxInfo_.end())
-              {
-                // insert into the map
-                this->vtxInfo_[vindex] = new VertexInfo(vertex_index, vptr);
-                // remember the vertex as a corner of the current face in temp_faces
-                temp_faces.back().corners[i].idx = vertex_index;
-                // increase the current index
-                vertex_index++;
-              }
-              else
-              {
-                // only insert the index into the simplices array
-                temp_faces.back().corners[i].idx = vimit->second->idx;
-              }
-            }
-
-            // now increase the current face index
-            simplex_index++;
-            break;
-          case 4 :
-            assert(dim == 3);
-            // we have a quadrilateral here
-            unsigned int vertex_indices[4];
-            unsigned int vertex_numbers[4];
-
-            // register the additional face(s) (2 simplices)
-            this->elmtInfo_[eindex]->faces += 2;
-
-            // get the vertex pointers for the quadrilateral's corner vertices
-            // and try for each of them whether it is already inserted or not
-            for (int i = 0; i < cube_corners; ++i)
-            {
-              // get the number of the vertex in the parent element
-              vertex_numbers[i] = orientedSubface<dim>(gt, *sit, i);
-
-              // get the vertex pointer and the index from the index set
-              VertexPtr vptr(elit->template subEntity<dim>(vertex_numbers[i]));
-              IndexType vindex = this->gv_.indexSet().template index<dim>(*vptr);
-
-              // if the vertex is not yet inserted in the vertex info map
-              // it is a new one -> it will be inserted now!
-              typename VertexInfoMap::iterator vimit = this->vtxInfo_.find(vindex);
-              if (vimit == this->vtxInfo_.end())
-              {
-                // insert into the map
-                this->vtxInfo_[vindex] = new VertexInfo(vertex_index, vptr);
-                // remember this vertex' index
-                vertex_indices[i] = vertex_index;
-                // increase the current index
-                vertex_index++;
-              }
-              else
-              {
-                // only remember the vertex' index
-                vertex_indices[i] = vimit->second->idx;
-              }
-            }
-
-            // now introduce the two triangles subdividing the quadrilateral
-            // ATTENTION: the order of vertices given by "orientedSubface" corresponds to the order
-            // of a Dune quadrilateral, i.e. the triangles are given by 0 1 2 and 3 2 1
-
-            // add a new face to the temporary collection for the first tri
-            temp_faces.push_back(SubEntityInfo(eindex, *sit,
-                                               Dune::GeometryType(Dune::GeometryType::simplex,dim-codim)));
-            temp_faces.back().corners[0].idx = vertex_indices[0];
-            temp_faces.back().corners[1].idx = vertex_indices[1];
-            temp_faces.back().corners[2].idx = vertex_indices[2];
-            // remember the vertices' numbers in parent element's vertices
-            temp_faces.back().corners[0].num = vertex_numbers[0];
-            temp_faces.back().corners[1].num = vertex_numbers[1];
-            temp_faces.back().corners[2].num = vertex_numbers[2];
-
-            // add a new face to the temporary collection for the second tri
-            temp_faces.push_back(SubEntityInfo(eindex, *sit,
-                                               Dune::GeometryType(Dune::GeometryType::simplex,dim-codim)));
-            temp_faces.back().corners[0].idx = vertex_indices[3];
-            temp_faces.back().corners[1].idx = vertex_indices[2];
-            temp_faces.back().corners[2].idx = vertex_indices[1];
-            // remember the vertices' numbers in parent element's vertices
-            temp_faces.back().corners[0].num = vertex_numbers[3];
-            temp_faces.back().corners[1].num = vertex_numbers[2];
-            temp_faces.back().corners[2].num = vertex_numbers[1];
-
-            simplex_index+=2;
-            break;
-          default :
-            DUNE_THROW(Dune::NotImplemented, "the extractor does only work for triangle and quadrilateral faces (" << face_corners << " corners)");
-            break;
-          }
-        }         // end loop over found surface parts
-      }
-    }     // end loop over elements
+      if (boundaryTraversal_)
+        boundaryElementsKey_ = this->gridKey();
+    }
 
     std::cout << "added " << simplex_index << " subfaces\n";
 
@@ -340,23 +439,277 @@ void Codim1Extractor<GV>::update(const ExtractorPredicate<GV,1>& descr)
     copy(temp_faces.begin(), temp_faces.end(), this->subEntities_.begin());
   }
 
+  // number the vertices and subentities along a space-filling curve
+  if (this->spatialOrdering_)
+    this->reorderSpatially();
+
+  // the corners of each subentity, for fast geometry access
+  this->computeCornerTables();
+
+  // match the new subentities against the previous ones
+  this->computeChanges(previousKeys);
+}
+
+
+template<typename GV>
+template<class Selector>
+void Codim1Extractor<GV>::extractElements(const Selector& select, const std::vector<ElementSeed>& changed)
+{
+  // single elements can only be extracted again as long as the grid is the same
+  this->checkIndexTables();
+  const bool useBoundaryElements = boundaryTraversal_ && boundaryElementsKey_ == this->gridKey();
+
+  // take the changed elements out of the patch...
+  std::vector<char> removed(this->subEntities_.size(), 0);
+  for (typename std::vector<ElementSeed>::const_iterator it = changed.begin(); it != changed.end(); ++it)
+    this->detachElement(this->cellMapper_.map(*this->gv_.grid().entityPointer(*it)), removed);
+
+  // ...and extract them again, their faces are numbered after the previous ones
+  int simplex_index = this->subEntities_.size();
+  std::deque<SubEntityInfo> temp_faces;
+  for (typename std::vector<ElementSeed>::const_iterator it = changed.begin(); it != changed.end(); ++it)
+  {
+    const ElementPtr eptr = this->gv_.grid().entityPointer(*it);
+    const IndexType eindex = this->cellMapper_.map(*eptr);
+    // an element given twice is only added once
+    if (this->elementTable_[eindex] < 0
+        && addFaces(eptr, select, *this, simplex_index, temp_faces) && useBoundaryElements)
+      // the next update() has to visit it, too
+      insertBoundaryElement(*it, eindex);
+  }
+
+  this->finishIncrementalUpdate(removed, temp_faces);
+}
+
+
+template<typename GV>
+template<class Selector>
+void Codim1Extractor<GV>::extractParallel(const Selector& select, int& simplex_index,
+                                          std::deque<SubEntityInfo>& temp_faces)
+{
+  // the elements to visit
+  const bool useBoundaryElements = boundaryTraversal_ && boundaryElementsKey_.valid();
+  std::vector<ElementSeed> allElements;
+  if (!useBoundaryElements)
+    for (ElementIter elit = this->gv_.template begin<0>(); elit != this->gv_.template end<0>(); ++elit)
+      allElements.push_back(elit->seed());
+  const std::vector<ElementSeed>& elements = useBoundaryElements ? boundaryElements_ : allElements;
+
+  // extract chunks of elements on several threads...
+  const std::size_t chunkSize = Dune::GridGlue::defaultChunkSize;
+  std::vector<ExtractedChunk> chunks((elements.size() + chunkSize - 1) / chunkSize);
+  std::vector<char> atBoundary(elements.size(), false);
+  Dune::GridGlue::parallelFor(elements.size(),
+                              ChunkExtractor<Selector>(*this, select, elements, chunks, atBoundary, chunkSize),
+                              chunkSize);
+  this->checkChunks(chunks);
+
+  // ...and put them together in element order
+  for (std::size_t c = 0; c < chunks.size(); ++c)
+  {
+    this->appendChunk(chunks[c], temp_faces);
+    chunks[c] = ExtractedChunk();
+  }
+  simplex_index = temp_faces.size();
+  this->computeCoordinates();
+
+  // remember the elements at the boundary for the next update
+  if (boundaryTraversal_ && !useBoundaryElements)
+  {
+    isBoundaryElement_.assign(this->cellMapper_.size(), false);
+    for (std::size_t i = 0; i < elements.size(); ++i)
+      if (atBoundary[i])
+        insertBoundaryElement(elements[i], this->cellMapper_.map(*this->gv_.grid().entityPointer(elements[i])));
+    boundaryElementsKey_ = this->gridKey();
+  }
+}
+
+
+template<typename GV>
+template<class Selector, class Sink>
+bool Codim1Extractor<GV>::addFaces(const ElementPtr& eptr, const Selector& select, Sink& sink,
+                                   int& simplex_index, std::deque<SubEntityInfo>& temp_faces) const
+{
+  Dune::GeometryType gt = eptr->type();
+
+  // remember the indices of the faces that shall become
+  // part of the surface, as bits of a mask
+  unsigned int boundary_faces = 0;
+  bool atBoundary = false;
 
-  // now first write the array with the coordinates...
-  this->coords_.resize(this->vtxInfo_.size());
-  typename VertexInfoMap::const_iterator it1 = this->vtxInfo_.begin();
-  for (; it1 != this->vtxInfo_.end(); ++it1)
+  // iterate over all intersections of codim 1 and test if the
+  // boundary intersections are to be added to the surface
+  for (IsIter is = this->gv_.ibegin(*eptr); is != this->gv_.iend(*eptr); ++is)
   {
-    // get a pointer to the associated info object
-    CoordinateInfo* current = &this->coords_[it1->second->idx];
-    // store this coordinates index // NEEDED?
-    current->index = it1->second->idx;
-    // store the vertex' index for the index2vertex mapping
-    current->vtxindex = it1->first;
-    // store the vertex' coordinates under the associated index
-    // in the coordinates array
-    current->coord = it1->second->p->geometry().corner(0);
+    // only look at boundary faces
+    if (!is->boundary())
+      continue;
+    atBoundary = true;
+    if (select(eptr, *is))
+      boundary_faces |= 1u << is->indexInInside();
   }
 
+  // if some face is part of the surface add it!
+  if (boundary_faces == 0)
+    return atBoundary;
+
+  // add an entry to the element table, the faces are counted below
+  const IndexType eindex = this->cellMapper_.map(*eptr);
+  ElementInfo & elementInfo = sink.insertElement(eptr, eindex, simplex_index);
+
+  // now add the faces in ascending order of their indices
+  for (int face = 0; boundary_faces != 0; ++face, boundary_faces >>= 1)
+  {
+    if (!(boundary_faces & 1))
+      continue;
+
+    // get the corner count of this face
+    const int face_corners = Dune::GenericReferenceElements<ctype, dim>::general(gt).size(face, 1, dim);
+
+    // now we only have to care about the 3D case, i.e. a triangle face can be
+    // inserted directly whereas a quadrilateral face has to be divided into two triangles
+    switch (face_corners)
+    {
+    case 2 :
+      assert(dim == 2);
+      // we have a line here
+
+      // register the additional face(s)
+      elementInfo.faces++;
+
+      // add a new face to the temporary collection
+      temp_faces.push_back(SubEntityInfo(eindex, face,
+                                         Dune::GeometryType(Dune::GeometryType::simplex,dim-codim)));
+
+      // try for each of the faces vertices whether it is already inserted or not
+      for (int i = 0; i < face_corners; ++i)
+      {
+        // get the number of the vertex in the parent element
+        int vertex_number = orientedSubface<2>(gt, face, i);
+
+        // get the vertex pointer and the index from the index set
+        VertexPtr vptr(eptr->template subEntity<dim>(vertex_number));
+        IndexType vindex = this->gv_.indexSet().template index<dim>(*vptr);
+
+        // remember the vertex' number in parent element's vertices
+        temp_faces.back().corners[i].num = vertex_number;
+
+        // add the vertex to the patch unless it is contained already,
+        // and remember its index
+        temp_faces.back().corners[i].idx = sink.insertVertex(vptr, vindex);
+      }
+
+      // now increase the current face index
+      simplex_index++;
+      break;
+    case 3 :
+      assert(dim == 3);
+      // we have a triangle here
+
+      // register the additional face(s)
+      elementInfo.faces++;
+
+      // add a new face to the temporary collection
+      temp_faces.push_back(SubEntityInfo(eindex, face,
+                                         Dune::GeometryType(Dune::GeometryType::simplex,dim-codim)));
+
+      // try for each of the faces vertices whether it is already inserted or not
+      for (int i = 0; i < simplex_corners; ++i)
+      {
+        // get the number of the vertex in the parent element
+        int vertex_number = orientedSubface<dim>(gt, face, i);
+
+        // get the vertex pointer and the index from the index set
+        VertexPtr vptr(eptr->template subEntity<dim>(vertex_number));
+        IndexType vindex = this->gv_.indexSet().template index<dim>(*vptr);
+
+        // remember the vertex' number in parent element's vertices
+        temp_faces.back().corners[i].num = vertex_number;
+
+        // add the vertex to the patch unless it is contained already,
+        // and remember its index
+        temp_faces.back().corners[i].idx = sink.insertVertex(vptr, vindex);
+      }
+
+      // now increase the current face index
+      simplex_index++;
+      break;
+    case 4 :
+      assert(dim == 3);
+      // we have a quadrilateral here
+      unsigned int vertex_indices[4];
+      unsigned int vertex_numbers[4];
+
+      // register the additional face(s) (2 simplices, or the quadrilateral itself)
+      elementInfo.faces += keepQuadrilaterals_ ? 1 : 2;
+
+      // get the vertex pointers for the quadrilateral's corner vertices
+      // and try for each of them whether it is already inserted or not
+      for (int i = 0; i < cube_corners; ++i)
+      {
+        // get the number of the vertex in the parent element
+        vertex_numbers[i] = orientedSubface<dim>(gt, face, i);
+
+        // get the vertex pointer and the index from the index set
+        VertexPtr vptr(eptr->template subEntity<dim>(vertex_numbers[i]));
+        IndexType vindex = this->gv_.indexSet().template index<dim>(*vptr);
+
+        // add the vertex to the patch unless it is contained already,
+        // and remember its index
+        vertex_indices[i] = sink.insertVertex(vptr, vindex);
+      }
+
+      if (keepQuadrilaterals_)
+      {
+        // add the quadrilateral as it is, the corners are in Dune order already
+        temp_faces.push_back(SubEntityInfo(eindex, face,
+                                           Dune::GeometryType(Dune::GeometryType::cube,dim-codim)));
+        for (int i = 0; i < cube_corners; ++i)
+        {
+          temp_faces.back().corners[i].idx = vertex_indices[i];
+          // remember the vertices' numbers in parent element's vertices
+          temp_faces.back().corners[i].num = vertex_numbers[i];
+        }
+
+        simplex_index++;
+        break;
+      }
+
+      // now introduce the two triangles subdividing the quadrilateral
+      // ATTENTION: the order of vertices given by "orientedSubface" corresponds to the order
+      // of a Dune quadrilateral, i.e. the triangles are given by 0 1 2 and 3 2 1
+
+      // add a new face to the temporary collection for the first tri
+      temp_faces.push_back(SubEntityInfo(eindex, face,
+                                         Dune::GeometryType(Dune::GeometryType::simplex,dim-codim)));
+      temp_faces.back().corners[0].idx = vertex_indices[0];
+      temp_faces.back().corners[1].idx = vertex_indices[1];
+      temp_faces.back().corners[2].idx = vertex_indices[2];
+      // remember the vertices' numbers in parent element's vertices
+      temp_faces.back().corners[0].num = vertex_numbers[0];
+      temp_faces.back().corners[1].num = vertex_numbers[1];
+      temp_faces.back().corners[2].num = vertex_numbers[2];
+
+      // add a new face to the temporary collection for the second tri
+      temp_faces.push_back(SubEntityInfo(eindex, face,
+                                         Dune::GeometryType(Dune::GeometryType::simplex,dim-codim)));
+      temp_faces.back().corners[0].idx = vertex_indices[3];
+      temp_faces.back().corners[1].idx = vertex_indices[2];
+      temp_faces.back().corners[2].idx = vertex_indices[1];
+      // remember the vertices' numbers in parent element's vertices
+      temp_faces.back().corners[0].num = vertex_numbers[3];
+      temp_faces.back().corners[1].num = vertex_numbers[2];
+      temp_faces.back().corners[2].num = vertex_numbers[1];
+
+      simplex_index+=2;
+      break;
+    default :
+      DUNE_THROW(Dune::NotImplemented, "the extractor does only work for triangle and quadrilateral faces (" << face_corners << " corners)");
+      break;
+    }
+  }         // end loop over found surface parts
+
+  return true;
 }
 
 #endif // DUNE_CODIM_1_EXTRACTOR_HH
@@ -22,6 +22,11 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <ostream>
+#include <string>
 #include <dune/common/exceptions.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/array.hh>
@@ -30,6 +35,10 @@
 #include <dune/grid/common/mcmgmapper.hh>
 #include <dune/geometry/genericgeometry/geometry.hh>
 
+#include <dune/grid-glue/common/cornergeometry.hh>
+#include <dune/grid-glue/common/parallelfor.hh>
+#include <dune/grid-glue/common/spacefillingcurve.hh>
+
 /**
  * @brief Provides codimension-independent methods for grid extraction
  *
@@ -73,6 +82,9 @@ public:
   typedef typename GV::Traits::template Codim<0>::Entity Element;
   typedef typename GV::Traits::template Codim<0>::Iterator ElementIter;
 
+  typedef typename GV::Grid::template Codim<dim>::EntitySeed VertexSeed;
+  typedef typename GV::Grid::template Codim<0>::EntitySeed ElementSeed;
+
   typedef std::vector<unsigned int>                                VertexVector;
 
   typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView, CellLayout> CellMapper;
@@ -84,6 +96,10 @@ public:
   typedef Dune::GenericGeometry::BasicGeometry<dim-codim, Dune::GenericGeometry::DefaultGeometryTraits<ctype,dim-codim,dimworld> > Geometry;
   typedef Dune::GenericGeometry::BasicGeometry<dim-codim, Dune::GenericGeometry::DefaultGeometryTraits<ctype,dim-codim,dim> > LocalGeometry;
 
+  // lightweight geometries pointing into the corner tables
+  typedef Dune::GridGlue::CornerGeometry<ctype, dim-codim, dimworld> WorldCornerGeometry;
+  typedef Dune::GridGlue::CornerGeometry<ctype, dim-codim, dim> LocalCornerGeometry;
+
 protected:
   /************************** PRIVATE SUBCLASSES **********************/
 
@@ -117,23 +133,25 @@ protected:
   };
 
   /**
-   * @brief simple struct holding a vertex pointer and an index
+   * @brief simple struct holding a vertex seed and an index
    */
   struct VertexInfo
   {
-    VertexInfo(unsigned int idx_, VertexPtr p_) : idx(idx_), p(p_)
+    VertexInfo(unsigned int idx_, const VertexSeed& s_) : idx(idx_), s(s_)
     {}
     unsigned int idx;
-    VertexPtr p;
+
+    /// @brief the seed of the vertex, much smaller than an entity pointer for most grids
+    VertexSeed s;
   };
 
 
   /**
-   * @brief simple struct holding an entity pointer and an index
+   * @brief simple struct holding an entity seed and an index
    */
   struct ElementInfo
   {
-    ElementInfo(unsigned int idx_, ElementPtr p_, unsigned int f_) : idx(idx_), faces(f_), p(p_)
+    ElementInfo(unsigned int idx_, const ElementSeed& s_, unsigned int f_) : idx(idx_), faces(f_), s(s_)
     {}
 
     /// @brief the index of this element's first face in the internal list of extracted faces
@@ -142,8 +160,8 @@ protected:
     /// @brief the number of extracted faces for this element
     unsigned int faces : 4;
 
-    /// @brief the entity pointer to the element
-    ElementPtr p;
+    /// @brief the seed of the element, much smaller than an entity pointer for most grids
+    ElementSeed s;
   };
 
 
@@ -186,8 +204,28 @@ protected:
   };
 
 
-  typedef std::map<IndexType, ElementInfo* >  ElementInfoMap;
-  typedef std::map<IndexType, VertexInfo* >   VertexInfoMap;
+  /**
+   * @brief key identifying an extracted subentity in the next complete update
+   *
+   * The subentity is looked up by the index of its parent element and its
+   * number in the parent, the hash of its corners tells whether it is still the
+   * same.  A subentity whose parent element has got a different index, e.g.
+   * after the grid has been adapted, counts as changed.
+   */
+  struct SubEntityKey
+  {
+    /// @brief the index of the parent element (from cellMapper_)
+    IndexType parent;
+
+    /// @brief the number of the face in the parent element
+    unsigned int num_in_parent;
+
+    /// @brief the hash of the corner numbers and world coordinates
+    std::size_t hash;
+  };
+
+  /// @brief the keys of all subentities, in the order of subEntities_
+  typedef std::vector<SubEntityKey> SubEntityKeys;
 
   /************************** MEMBER VARIABLES ************************/
 
@@ -202,22 +240,386 @@ protected:
   /// @brief all information about the extracted subEntities
   std::vector<SubEntityInfo>    subEntities_;
 
-  /// @brief a map enabling faster access to vertices and coordinates
-  ///
-  /// Maps a vertex' index (from index set) to an object holding the locally
-  /// associated index of the vertex' coordinate in coords_ and an entity
-  /// pointer to the codim<dim> entity.
-  VertexInfoMap vtxInfo_;
+  /// @brief the world coordinates of the corners of each subentity, cube_corners entries per subentity
+  std::vector<Coords> worldCorners_;
+
+  /// @brief the corners of each subentity in the coordinates of the parent element, cube_corners entries per subentity
+  std::vector<LocalCoords> localCorners_;
 
-  /// @brief a map enabling faster access to elements and faces
+  /// @brief the vertices of the patch, in the order of coords_
+  std::vector<VertexInfo> vertices_;
+
+  /// @brief the elements with extracted subentities, in the order of their first subentity
   ///
-  /// Maps an element's index (from index set) to an object holding the locally
-  /// associated index of its first face in _indices (if there are more they are
-  /// positioned consecutively) and an entity pointer to the codim<0> entity.
-  ElementInfoMap elmtInfo_;
+  /// Each entry holds the locally associated index of the element's first face in
+  /// subEntities_ (if there are more they are positioned consecutively) and the
+  /// seed of the codim<0> entity.
+  std::vector<ElementInfo> elements_;
+
+  /// @brief the position in vertices_ for each vertex of the grid view (from index set),
+  /// -1 if the vertex is not in the patch
+  std::vector<int> vertexTable_;
+
+  /// @brief the position in elements_ for each element of the grid view (from cellMapper_),
+  /// -1 if no subentity of the element is in the patch
+  std::vector<int> elementTable_;
 
   CellMapper cellMapper_;
 
+  /*        Change Tracking                                        */
+
+  /// @brief whether subsequent updates compare the patch to the previous one
+  bool trackChanges_;
+
+  /// @brief the keys of the current subentities (only filled if trackChanges_ is set)
+  SubEntityKeys subEntityKeys_;
+
+  /// @brief for each subentity its index in the previous extraction, or -1 if it is new
+  std::vector<int> previousIndex_;
+
+  /// @brief the number of subentities in the previous extraction
+  unsigned int nPreviousSubEntities_;
+
+  /// @brief counts the updates that may have changed the subentities
+  unsigned long topologyRevision_;
+
+  /// @brief counts the updates that may have changed the coordinates, including the ones counted by topologyRevision_
+  unsigned long coordinateRevision_;
+
+  /// @brief counts the calls of gridChanged()
+  unsigned long gridRevision_;
+
+  /**
+   * @brief identifies a state of the grid view, see gridKey()
+   */
+  struct GridKey
+  {
+    GridKey() : revision(0) {}
+
+    /** @brief whether the key has been taken from a grid view at all */
+    bool valid() const { return !sizes.empty(); }
+
+    bool operator== (const GridKey& other) const
+    {
+      return revision == other.revision && sizes == other.sizes;
+    }
+
+    bool operator!= (const GridKey& other) const
+    {
+      return !(*this == other);
+    }
+
+    /// @brief the value of gridRevision_
+    unsigned long revision;
+
+    /// @brief the number of entities of each codimension
+    std::vector<int> sizes;
+  };
+
+  /// @brief the state of the grid view when the index tables were sized, invalid if they are empty
+  GridKey indexTablesKey_;
+
+  /**
+   * @brief the current state of the grid view
+   *
+   * Information about the grid that is kept across updates has to be
+   * collected again when the key changes.  The key changes with every call of
+   * gridChanged() and with the number of entities of any codimension.
+   */
+  GridKey gridKey() const
+  {
+    GridKey key;
+    key.revision = gridRevision_;
+    for (int c = 0; c <= dim; ++c)
+      key.sizes.push_back(gv_.size(c));
+    return key;
+  }
+
+  /**
+   * @brief compare the current extraction to the previous one
+   *
+   * To be called by the derived classes at the end of update(), it also
+   * counts the update in the revisions.
+   * @param previousKeys the subentity keys of the previous extraction
+   */
+  void computeChanges(const SubEntityKeys& previousKeys);
+
+  /** @brief compute the key of an extracted subentity */
+  SubEntityKey subEntityKey(unsigned int index) const;
+
+  /**
+   * @brief fill worldCorners_ and localCorners_
+   *
+   * To be called by the derived classes at the end of update(), before computeChanges().
+   */
+  void computeCornerTables();
+
+  /**
+   * @brief size the vertex and element tables for the current grid view
+   *
+   * To be called by the derived classes at the beginning of update(), after clear().
+   */
+  void resetIndexTables()
+  {
+    vertexTable_.assign(gv_.indexSet().size(dim), -1);
+    elementTable_.assign(cellMapper_.size(), -1);
+    indexTablesKey_ = gridKey();
+  }
+
+  /**
+   * @brief add a vertex to the patch unless it is contained already
+   * @param vptr the vertex
+   * @param vindex the index of the vertex (from index set)
+   * @return the index of the vertex in coords_
+   */
+  unsigned int insertVertex(const VertexPtr& vptr, IndexType vindex)
+  {
+    if (vertexTable_[vindex] < 0)
+    {
+      insertVertex(vptr->seed(), vindex);
+      coords_.back().coord = vptr->geometry().corner(0);
+    }
+    return vertexTable_[vindex];
+  }
+
+  /**
+   * @brief add a vertex to the patch unless it is contained already, without computing its coordinate
+   * @param seed the seed of the vertex
+   * @param vindex the index of the vertex (from index set)
+   * @return the index of the vertex in coords_
+   */
+  unsigned int insertVertex(const VertexSeed& seed, IndexType vindex)
+  {
+    if (vertexTable_[vindex] < 0)
+    {
+      vertexTable_[vindex] = vertices_.size();
+      vertices_.push_back(VertexInfo(vertices_.size(), seed));
+      coords_.push_back(CoordinateInfo(vertexTable_[vindex], vindex));
+    }
+    return vertexTable_[vindex];
+  }
+
+  /**
+   * @brief add an element to the patch
+   * @param eptr the element
+   * @param eindex the index of the element (from cellMapper_)
+   * @param first the index of the element's first subentity
+   * @return the element's entry, its face count can be increased while subentities are added
+   */
+  ElementInfo & insertElement(const ElementPtr& eptr, IndexType eindex, unsigned int first)
+  {
+    elementTable_[eindex] = elements_.size();
+    elements_.push_back(ElementInfo(first, eptr->seed(), 0));
+    return elements_.back();
+  }
+
+  /** @brief the entry of an element that has extracted subentities */
+  const ElementInfo & elementInfo(IndexType eindex) const
+  {
+    return elements_[elementTable_[eindex]];
+  }
+
+  /*        Incremental Update                                     */
+
+  /**
+   * @brief whether the index tables still fit the grid view
+   *
+   * Only then single elements can be extracted again, otherwise the
+   * whole patch has to be rebuilt.  The tables are invalid once the number
+   * of entities has changed or gridChanged() has been called since the last
+   * complete update.
+   */
+  bool indexTablesValid() const
+  {
+    return indexTablesKey_.valid() && indexTablesKey_ == gridKey();
+  }
+
+  /**
+   * @brief make sure that single elements can be extracted again, for an incremental update
+   *
+   * Updates cellMapper_ and throws if the index tables do not fit the grid view.
+   */
+  void checkIndexTables()
+  {
+    cellMapper_.update();
+    if (!indexTablesValid() || elementTable_.size() != std::size_t(cellMapper_.size()))
+      DUNE_THROW(Dune::InvalidStateException, "The grid has changed since the last complete update(), "
+                 "call update() without a change set");
+  }
+
+  /**
+   * @brief take the subentities of an element out of the patch, for an incremental update
+   * @param eindex the index of the element (from cellMapper_)
+   * @param removed one flag per subentity, set for the subentities of the element
+   */
+  void detachElement(IndexType eindex, std::vector<char>& removed)
+  {
+    if (elementTable_[eindex] < 0)
+      return;
+    const ElementInfo & info = elements_[elementTable_[eindex]];
+    for (unsigned int i = 0; i < info.faces; ++i)
+      removed[info.idx + i] = 1;
+    elementTable_[eindex] = -1;
+  }
+
+  /**
+   * @brief put the patch together again after an incremental update
+   *
+   * Drops the detached subentities, their elements and the vertices that are no
+   * longer used, appends the extracted subentities and records which subentities
+   * have changed.  Subentities that were kept but share a vertex with a moved
+   * element count as changed, too.
+   * @param removed the flags set by detachElement()
+   * @param temp_faces the extracted subentities, numbered after the previous ones
+   */
+  void finishIncrementalUpdate(const std::vector<char>& removed, const std::deque<SubEntityInfo>& temp_faces);
+
+  /** @brief fill the entries of one subentity in worldCorners_ and localCorners_ */
+  void computeCorners(unsigned int index);
+
+  /*        Spatial Ordering                                       */
+
+  /// @brief whether update() numbers the vertices and subentities along a space-filling curve
+  bool spatialOrdering_;
+
+  /**
+   * @brief number the vertices and the elements with their subentities along a Morton curve
+   *
+   * To be called by the derived classes in update(), after subEntities_ has
+   * been filled and before computeCornerTables().
+   */
+  void reorderSpatially();
+
+  /*        Parallel Extraction                                    */
+
+  /// @brief whether update() extracts the elements in chunks on several threads
+  bool parallelExtraction_;
+
+  /**
+   * @brief the part of the patch extracted by one thread from a range of elements
+   *
+   * It offers insertVertex() and insertElement() like the extractor itself, so
+   * the derived classes can use the same code to extract an element directly
+   * into the extractor or into a chunk.  The vertices are numbered by their
+   * position in the chunk and may appear more than once.  The element and face
+   * indices count from the beginning of the chunk.  appendChunk() translates
+   * both when the chunks are put together.
+   */
+  struct ExtractedChunk
+  {
+    ExtractedChunk() : nFaces(0) {}
+
+    unsigned int insertVertex(const VertexPtr& vptr, IndexType vindex)
+    {
+      vertexSeeds.push_back(vptr->seed());
+      vertexIndices.push_back(vindex);
+      return vertexIndices.size() - 1;
+    }
+
+    ElementInfo & insertElement(const ElementPtr& eptr, IndexType eindex, unsigned int first)
+    {
+      elementIndices.push_back(eindex);
+      elements.push_back(ElementInfo(first, eptr->seed(), 0));
+      return elements.back();
+    }
+
+    /// @brief the seed and the index (from index set) of each vertex, in the order they were inserted
+    std::vector<VertexSeed> vertexSeeds;
+    std::vector<IndexType> vertexIndices;
+
+    /// @brief the elements and their indices (from cellMapper_)
+    std::vector<ElementInfo> elements;
+    std::vector<IndexType> elementIndices;
+
+    /// @brief the extracted subentities, the corner indices refer to vertexIndices
+    std::deque<SubEntityInfo> faces;
+
+    /// @brief the number of extracted subentities, the counter for the face indices
+    int nFaces;
+
+    /// @brief the message of an exception thrown while extracting the chunk, empty if there was none
+    std::string error;
+  };
+
+  /**
+   * @brief throw the first error recorded in the chunks
+   *
+   * An exception must not leave a thread of an OpenMP loop, hence the chunks
+   * catch it and it is thrown again once all threads have finished.
+   */
+  static void checkChunks(const std::vector<ExtractedChunk>& chunks)
+  {
+    for (std::size_t c = 0; c < chunks.size(); ++c)
+      if (!chunks[c].error.empty())
+        DUNE_THROW(Dune::Exception, "extracting a chunk of elements failed: " << chunks[c].error);
+  }
+
+  /**
+   * @brief add the vertices, elements and subentities of a chunk to the patch
+   *
+   * Appending the chunks in the order of their elements numbers the vertices
+   * exactly like the serial extraction does.
+   * @param chunk the extracted chunk
+   * @param temp_faces the subentities are appended here
+   */
+  void appendChunk(const ExtractedChunk& chunk, std::deque<SubEntityInfo>& temp_faces);
+
+  /** @brief apply no transformation in refreshCoordinates() */
+  struct IdentityTransform
+  {
+    Coords operator() (const Coords& x) const
+    {
+      return x;
+    }
+  };
+
+  /** @brief read coords_[begin] ... coords_[end-1] from the grid again, and flag the ones that have moved */
+  template<class Transform>
+  struct RefreshChunk
+  {
+    RefreshChunk(Extractor& extractor, const Transform& transform, std::vector<char>& moved)
+      : extractor_(extractor), transform_(transform), moved_(moved)
+    {}
+
+    void operator() (std::size_t begin, std::size_t end) const
+    {
+      for (std::size_t i = begin; i < end; ++i)
+      {
+        const Coords coord = transform_(extractor_.gv_.grid().entityPointer(extractor_.vertices_[i].s)->geometry().corner(0));
+        moved_[i] = (coord != extractor_.coords_[i].coord);
+        extractor_.coords_[i].coord = coord;
+      }
+    }
+
+    Extractor& extractor_;
+    const Transform& transform_;
+    std::vector<char>& moved_;
+  };
+
+  /** @brief compute coords_[begin] ... coords_[end-1] from the vertex seeds */
+  struct CoordinateChunk
+  {
+    CoordinateChunk(Extractor& extractor) : extractor_(extractor) {}
+
+    void operator() (std::size_t begin, std::size_t end) const
+    {
+      for (std::size_t i = begin; i < end; ++i)
+        extractor_.coords_[i].coord = extractor_.gv_.grid().entityPointer(extractor_.vertices_[i].s)->geometry().corner(0);
+    }
+
+    Extractor& extractor_;
+  };
+
+  /**
+   * @brief compute the coordinates of all vertices, in parallel
+   *
+   * To be called after the chunks have been appended.
+   */
+  void computeCoordinates()
+  {
+    Dune::GridGlue::parallelFor(coords_.size(), CoordinateChunk(*this));
+  }
+
 public:
 
   /*  C O N S T R U C T O R S   A N D   D E S T R U C T O R S  */
@@ -227,7 +629,9 @@ public:
    * @param gv the grid view object to work with
    */
   Extractor(const GV& gv)
-    :  gv_(gv), cellMapper_(gv)
+    :  gv_(gv), cellMapper_(gv), trackChanges_(false), nPreviousSubEntities_(0),
+      topologyRevision_(0), coordinateRevision_(0), gridRevision_(0), spatialOrdering_(false),
+      parallelExtraction_(false)
   {}
 
   /** \brief Destructor frees allocated memory */
@@ -251,20 +655,131 @@ public:
       subEntities_.swap(dummy);
     }
 
-    // first free all manually allocated vertex/element info items...
-    for (typename VertexInfoMap::iterator it = vtxInfo_.begin();
-         it != vtxInfo_.end(); ++it)
-      if (it->second != NULL)
-        delete it->second;
-    for (typename ElementInfoMap::iterator it = elmtInfo_.begin();
-         it != elmtInfo_.end(); ++it)
-      if (it->second != NULL)
-        delete it->second;
-    // ...then clear the maps themselves, too
-    vtxInfo_.clear();
-    elmtInfo_.clear();
+    {
+      std::vector<Coords> dummy;
+      worldCorners_.swap(dummy);
+    }
+    {
+      std::vector<LocalCoords> dummy;
+      localCorners_.swap(dummy);
+    }
+    {
+      std::vector<VertexInfo> dummy;
+      vertices_.swap(dummy);
+    }
+    {
+      std::vector<ElementInfo> dummy;
+      elements_.swap(dummy);
+    }
+    {
+      std::vector<int> dummy;
+      vertexTable_.swap(dummy);
+    }
+    {
+      std::vector<int> dummy;
+      elementTable_.swap(dummy);
+    }
+    indexTablesKey_ = GridKey();
+  }
+
+
+  /**
+   * @brief switch the comparison of subsequent updates with the previous extraction on or off
+   *
+   * If set, each update() matches the new subentities against the ones of the
+   * previous update.  The result can be queried using previousIndex(),
+   * getChangedSubEntities() and getRemovedSubEntities() and allows
+   * GridGlue::buildIncremental() to recompute only the affected intersections.
+   * The incremental updates of the derived classes always report their changes,
+   * the setting only decides whether the next complete update can compare
+   * against them.
+   */
+  bool & trackChanges() { return trackChanges_; }
+  const bool & trackChanges() const { return trackChanges_; }
+
+  /**
+   * @brief tell the extractor that the grid has been modified, e.g. adapted or load balanced
+   *
+   * The information about the grid that the extractor keeps across updates,
+   * like the elements at the boundary, is collected again by the next update().
+   * Changes of the number of entities are detected without this call, but a
+   * modification that keeps all numbers has to be announced.  An incremental
+   * update throws until the next complete update().
+   */
+  void gridChanged()
+  {
+    ++gridRevision_;
+  }
+
+  /**
+   * @brief switch the extraction on several threads on or off
+   *
+   * If set, update() splits the elements into chunks that are extracted on
+   * the OpenMP threads, and puts the results together in element order.  The
+   * patch is the same as with the serial extraction, including the numbering
+   * of vertices and subentities.  The predicate and the grid implementation
+   * have to allow concurrent read access.  An exception thrown while extracting
+   * is caught on its thread and thrown again as a Dune::Exception with the same
+   * message once all threads have finished.
+   */
+  bool & parallelExtraction() { return parallelExtraction_; }
+  const bool & parallelExtraction() const { return parallelExtraction_; }
+
+  /**
+   * @brief switch the numbering of the patch along a space-filling curve on or off
+   *
+   * By default the vertices and subentities are numbered in the order of the
+   * grid traversal, which for unstructured grids scatters neighbouring faces
+   * over the coordinate array.  If set, each complete update() sorts the
+   * vertices and the elements along a Morton curve through the patch.  The
+   * subentities of an element stay consecutive, and the mappings to the grid
+   * indices, e.g. faceIndices() and element(), are kept consistent.  The
+   * incremental updates append their subentities without sorting them.
+   */
+  bool & spatialOrdering() { return spatialOrdering_; }
+  const bool & spatialOrdering() const { return spatialOrdering_; }
+
+  /**
+   * @brief read the vertex positions from the grid again, keeping the subentities
+   *
+   * For grids whose vertices move while the extracted surface stays the same,
+   * e.g. in ALE or rigid body problems.  The grid is not traversed, only the
+   * coordinates and the world corners of the subentities are computed again, on
+   * several threads if parallelExtraction() is set.  The subentities with a moved
+   * corner are reported as changed, see getChangedSubEntities().  Call update()
+   * instead if the grid has been adapted or the selection may have changed.
+   */
+  void refreshCoordinates()
+  {
+    refreshCoordinates(IdentityTransform());
   }
 
+  /**
+   * @brief read the vertex positions from the grid again and transform them, keeping the subentities
+   *
+   * Like refreshCoordinates(), but the patch gets the transformed positions,
+   * e.g. to apply a displacement that the grid does not know about.  A later
+   * update() reads the untransformed positions again.  If trackChanges() is
+   * set, the keys of the moved subentities are computed from the transformed
+   * positions, so the next update() reports them as changed.
+   * @param transform a callable with the signature Coords(const Coords&)
+   */
+  template<class Transform>
+  void refreshCoordinates(const Transform& transform);
+
+  /**
+   * @brief counts the updates that may have changed the subentities
+   *
+   * Users of the patch can compare it to the value they have seen before to
+   * find out whether they have to read the faces again.
+   */
+  unsigned long topologyRevision() const { return topologyRevision_; }
+
+  /**
+   * @brief counts the updates that may have changed the coordinates, including all updates of the subentities
+   */
+  unsigned long coordinateRevision() const { return coordinateRevision_; }
+
 
   /*  G E T T E R S  */
 
@@ -290,6 +805,15 @@ public:
     return coords_.size();
   }
 
+  /**
+   * @brief getter for the count of extracted subentities
+   * @return the count
+   */
+  unsigned int nSubEntities() const
+  {
+    return subEntities_.size();
+  }
+
   /** \brief Get the list of geometry types */
   void getGeometryTypes(std::vector<Dune::GeometryType>& geometryTypes) const
   {
@@ -323,17 +847,16 @@ public:
    */
   bool faceIndices(const Element& e, int& first, int& count) const
   {
-    typename ElementInfoMap::const_iterator it =
-      elmtInfo_.find(cellMapper_.map(e));
-    if (it == elmtInfo_.end())
+    const IndexType eindex = cellMapper_.map(e);
+    if (eindex < 0 || std::size_t(eindex) >= elementTable_.size() || elementTable_[eindex] < 0)
     {
       first = -1;
       count = 0;
       return false;
     }
-    // the iterator is valid, fill the out params
-    first = it->second->idx;
-    count = it->second->faces;
+    // the element is in the patch, fill the out params
+    first = elementInfo(eindex).idx;
+    count = elementInfo(eindex).faces;
     return true;
   }
 
@@ -370,13 +893,13 @@ public:
    * @brief gets the parent element for a given face index,
    * throws an exception if index not valid
    * @param index the index of the face
-   * @return a reference to the element's stored pointer
+   * @return a pointer to the element, created from its stored seed
    */
-  const ElementPtr& element(unsigned int index) const
+  ElementPtr element(unsigned int index) const
   {
     if (index >= subEntities_.size())
       DUNE_THROW(Dune::GridError, "invalid face index");
-    return (elmtInfo_.find(subEntities_[index].parent))->second->p;
+    return gv_.grid().entityPointer(elementInfo(subEntities_[index].parent).s);
   }
 
 #if 1
@@ -384,22 +907,113 @@ public:
    * @brief gets the vertex for a given coordinate index
    * throws an exception if index not valid
    * @param index the index of the coordinate
-   * @return a reference to the vertex' stored pointer
+   * @return a pointer to the vertex, created from its stored seed
    */
-  const VertexPtr& vertex(unsigned int index) const
+  VertexPtr vertex(unsigned int index) const
   {
     if (index >= coords_.size())
       DUNE_THROW(Dune::GridError, "invalid coordinate index");
-    return (vtxInfo_.find(coords_[index].vtxindex))->second->p;
+    return gv_.grid().entityPointer(vertices_[index].s);
   }
 #endif
 
+  /**
+   * @brief index of a subentity in the previous extraction
+   * @param index the index of the subentity in the current extraction
+   * @return the previous index, or -1 if the subentity is new or has changed
+   */
+  int previousIndex(unsigned int index) const
+  {
+    return index < previousIndex_.size() ? previousIndex_[index] : -1;
+  }
+
+  /**
+   * @brief get the subentities that are new or have changed since the previous update
+   * @param changed will be filled with the (current) subentity indices
+   */
+  void getChangedSubEntities(std::vector<unsigned int>& changed) const
+  {
+    changed.clear();
+    for (unsigned int i = 0; i < subEntities_.size(); ++i)
+      if (previousIndex(i) < 0)
+        changed.push_back(i);
+  }
+
+  /**
+   * @brief get the subentities of the previous update that have vanished or changed
+   * @param removed will be filled with the (previous) subentity indices
+   */
+  void getRemovedSubEntities(std::vector<unsigned int>& removed) const
+  {
+    std::vector<int> old2new;
+    getSubEntityMapping(old2new);
+    removed.clear();
+    for (unsigned int i = 0; i < old2new.size(); ++i)
+      if (old2new[i] < 0)
+        removed.push_back(i);
+  }
+
+  /**
+   * @brief map the subentity indices of the previous extraction to the current ones
+   * @param old2new will be resized to the number of previously extracted subentities
+   * and contains the current index, or -1 if the subentity was removed or has changed
+   */
+  void getSubEntityMapping(std::vector<int>& old2new) const
+  {
+    old2new.assign(nPreviousSubEntities_, -1);
+    for (unsigned int i = 0; i < previousIndex_.size(); ++i)
+      if (previousIndex_[i] >= 0)
+        old2new[previousIndex_[i]] = i;
+  }
+
+  /**
+   * @brief the number of bytes allocated by this extractor
+   *
+   * This counts the capacity of the internal tables, but not the memory
+   * referenced by the entity seeds.
+   */
+  std::size_t memoryUsage() const;
+
+  /**
+   * @brief print the memory used by the internal tables, in total and per extracted face
+   */
+  void memoryReport(std::ostream& os) const;
+
   /** \brief Get world geometry of the extracted face */
   Geometry geometry(unsigned int index) const;
 
   /** \brief Get geometry of the extracted face in element coordinates */
   LocalGeometry geometryLocal(unsigned int index) const;
 
+  /**
+   * \brief whether cornerGeometry() and localCornerGeometry() support the face, i.e. it is a simplex or a cube
+   */
+  bool hasCornerGeometry(unsigned int index) const
+  {
+    const Dune::GeometryType & type = subEntities_[index].geometryType_;
+    return type.isSimplex() || type.isCube();
+  }
+
+  /**
+   * \brief Get world geometry of the extracted face, without allocation
+   *
+   * The geometry points into the corner tables, it is valid until the next update().
+   */
+  WorldCornerGeometry cornerGeometry(unsigned int index) const
+  {
+    return WorldCornerGeometry(subEntities_[index].geometryType_, &worldCorners_[index*cube_corners]);
+  }
+
+  /**
+   * \brief Get geometry of the extracted face in element coordinates, without allocation
+   *
+   * The geometry points into the corner tables, it is valid until the next update().
+   */
+  LocalCornerGeometry localCornerGeometry(unsigned int index) const
+  {
+    return LocalCornerGeometry(subEntities_[index].geometryType_, &localCorners_[index*cube_corners]);
+  }
+
 };
 
 
@@ -410,37 +1024,419 @@ Extractor<GV,cd>::~Extractor()
 }
 
 
-/** \brief Get World geometry of the extracted face */
 template<typename GV, int cd>
-typename Extractor<GV,cd>::Geometry Extractor<GV,cd>::geometry(unsigned int index) const
+typename Extractor<GV,cd>::SubEntityKey Extractor<GV,cd>::subEntityKey(unsigned int index) const
 {
-  std::vector<Coords> corners(subEntities_[index].nCorners());
-  for (unsigned int i = 0; i < subEntities_[index].nCorners(); ++i)
-    corners[i] = coords_[subEntities_[index].corners[i].idx].coord;
+  const SubEntityInfo & face = subEntities_[index];
 
-  return Geometry(subEntities_[index].geometryType_, corners);
+  SubEntityKey key;
+  key.parent = face.parent;
+  key.num_in_parent = face.num_in_parent;
+
+  // FNV-1a over the corner numbers and the bytes of the corner coordinates
+  key.hash = 2166136261u;
+  for (unsigned int i = 0; i < face.nCorners(); ++i)
+  {
+    key.hash = (key.hash ^ face.corners[i].num) * 16777619u;
+    for (int j = 0; j < dimworld; ++j)
+    {
+      const ctype x = coords_[face.corners[i].idx].coord[j];
+      const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&x);
+      for (std::size_t b = 0; b < sizeof(ctype); ++b)
+        key.hash = (key.hash ^ bytes[b]) * 16777619u;
+    }
+  }
+  return key;
 }
 
 
-/** \brief Get Geometry of the extracted face in element coordinates */
 template<typename GV, int cd>
-typename Extractor<GV,cd>::LocalGeometry Extractor<GV,cd>::geometryLocal(unsigned int index) const
+void Extractor<GV,cd>::computeChanges(const SubEntityKeys& previousKeys)
+{
+  ++topologyRevision_;
+  ++coordinateRevision_;
+
+  nPreviousSubEntities_ = previousKeys.size();
+  previousIndex_.assign(subEntities_.size(), -1);
+  SubEntityKeys().swap(subEntityKeys_);
+
+  if (!trackChanges_)
+    return;
+
+  // the first previous subentity of each element, the others follow it
+  std::vector<int> previousFirst(cellMapper_.size(), -1);
+  for (unsigned int i = previousKeys.size(); i-- > 0; )
+    if (std::size_t(previousKeys[i].parent) < previousFirst.size())
+      previousFirst[previousKeys[i].parent] = i;
+
+  subEntityKeys_.resize(subEntities_.size());
+  for (unsigned int i = 0; i < subEntities_.size(); ++i)
+  {
+    const SubEntityKey key = subEntityKey(i);
+    subEntityKeys_[i] = key;
+
+    for (int k = previousFirst[key.parent];
+         k >= 0 && std::size_t(k) < previousKeys.size() && previousKeys[k].parent == key.parent; ++k)
+      if (previousKeys[k].num_in_parent == key.num_in_parent && previousKeys[k].hash == key.hash)
+      {
+        previousIndex_[i] = k;
+        break;
+      }
+  }
+}
+
+
+template<typename GV, int cd>
+template<class Transform>
+void Extractor<GV,cd>::refreshCoordinates(const Transform& transform)
+{
+  ++coordinateRevision_;
+
+  std::vector<char> moved(coords_.size(), 0);
+  RefreshChunk<Transform> refresh(*this, transform, moved);
+  if (parallelExtraction_)
+    Dune::GridGlue::parallelFor(coords_.size(), refresh);
+  else
+    refresh(0, coords_.size());
+
+  // the subentities with a moved corner have changed, the others keep their index
+  nPreviousSubEntities_ = subEntities_.size();
+  previousIndex_.assign(subEntities_.size(), -1);
+  for (unsigned int index = 0; index < subEntities_.size(); ++index)
+  {
+    const SubEntityInfo & face = subEntities_[index];
+    bool touched = false;
+    for (unsigned int i = 0; i < face.nCorners(); ++i)
+      touched = touched || moved[face.corners[i].idx];
+
+    if (!touched)
+    {
+      previousIndex_[index] = index;
+      continue;
+    }
+    for (unsigned int i = 0; i < face.nCorners(); ++i)
+      worldCorners_[index*cube_corners + i] = coords_[face.corners[i].idx].coord;
+  }
+
+  // keep the keys up to date for the next complete update
+  if (trackChanges_)
+  {
+    const bool complete = (subEntityKeys_.size() != subEntities_.size());
+    subEntityKeys_.resize(subEntities_.size());
+    for (unsigned int index = 0; index < subEntities_.size(); ++index)
+      if (complete || previousIndex_[index] < 0)
+        subEntityKeys_[index] = subEntityKey(index);
+  }
+}
+
+
+template<typename GV, int cd>
+void Extractor<GV,cd>::appendChunk(const ExtractedChunk& chunk, std::deque<SubEntityInfo>& temp_faces)
 {
-  std::vector<LocalCoords> corners(subEntities_[index].nCorners());
+  // the position of each chunk vertex in the patch
+  std::vector<unsigned int> patchVertex(chunk.vertexIndices.size());
+  for (std::size_t i = 0; i < chunk.vertexIndices.size(); ++i)
+    patchVertex[i] = insertVertex(chunk.vertexSeeds[i], chunk.vertexIndices[i]);
+
+  const unsigned int firstFace = temp_faces.size();
+  for (std::size_t i = 0; i < chunk.elements.size(); ++i)
+  {
+    elementTable_[chunk.elementIndices[i]] = elements_.size();
+    elements_.push_back(chunk.elements[i]);
+    elements_.back().idx = firstFace + chunk.elements[i].idx;
+  }
+
+  for (typename std::deque<SubEntityInfo>::const_iterator it = chunk.faces.begin(); it != chunk.faces.end(); ++it)
+  {
+    temp_faces.push_back(*it);
+    for (unsigned int j = 0; j < it->nCorners(); ++j)
+      temp_faces.back().corners[j].idx = patchVertex[it->corners[j].idx];
+  }
+}
+
+
+template<typename GV, int cd>
+std::size_t Extractor<GV,cd>::memoryUsage() const
+{
+  std::size_t bytes = sizeof(*this);
+  bytes += coords_.capacity() * sizeof(CoordinateInfo);
+  bytes += subEntities_.capacity() * sizeof(SubEntityInfo);
+  bytes += worldCorners_.capacity() * sizeof(Coords) + localCorners_.capacity() * sizeof(LocalCoords);
+  bytes += vertices_.capacity() * sizeof(VertexInfo);
+  bytes += elements_.capacity() * sizeof(ElementInfo);
+  bytes += (vertexTable_.capacity() + elementTable_.capacity()) * sizeof(int);
+  bytes += previousIndex_.capacity() * sizeof(int);
+  bytes += subEntityKeys_.capacity() * sizeof(SubEntityKey);
+  return bytes;
+}
+
 
-  // get face info
+template<typename GV, int cd>
+void Extractor<GV,cd>::memoryReport(std::ostream& os) const
+{
+  const std::size_t faces = subEntities_.size();
+  const std::size_t total = memoryUsage();
+
+  os << "Extractor memory: " << total << " bytes for " << faces << " faces and "
+     << coords_.size() << " vertices";
+  if (faces > 0)
+    os << ", " << double(total) / faces << " bytes per face";
+  os << std::endl;
+  os << "  vertices:     " << vertices_.capacity() << " x " << sizeof(VertexInfo) << " bytes" << std::endl;
+  os << "  elements:     " << elements_.capacity() << " x " << sizeof(ElementInfo) << " bytes" << std::endl;
+  os << "  coordinates:  " << coords_.capacity() << " x " << sizeof(CoordinateInfo) << " bytes" << std::endl;
+  os << "  subentities:  " << subEntities_.capacity() << " x " << sizeof(SubEntityInfo) << " bytes" << std::endl;
+  os << "  corners:      " << worldCorners_.capacity() << " x " << sizeof(Coords)
+     << " + " << localCorners_.capacity() << " x " << sizeof(LocalCoords) << " bytes" << std::endl;
+  os << "  index tables: " << vertexTable_.capacity() + elementTable_.capacity() << " x " << sizeof(int) << " bytes" << std::endl;
+}
+
+
+template<typename GV, int cd>
+void Extractor<GV,cd>::computeCornerTables()
+{
+  worldCorners_.resize(subEntities_.size() * cube_corners);
+  localCorners_.resize(subEntities_.size() * cube_corners);
+
+  for (unsigned int index = 0; index < subEntities_.size(); ++index)
+    computeCorners(index);
+}
+
+
+template<typename GV, int cd>
+void Extractor<GV,cd>::computeCorners(unsigned int index)
+{
   const SubEntityInfo & face = subEntities_[index];
-  Dune::GeometryType facetype = subEntities_[index].geometryType_;
 
-  // get reference element
-  Dune::GeometryType celltype = elmtInfo_.find(face.parent)->second->p->type();
+  // get reference element of the parent
+  Dune::GeometryType celltype = element(index)->type();
   const Dune::GenericReferenceElement<ctype, dim> & re =
     Dune::GenericReferenceElements<ctype, dim>::general(celltype);
 
+  for (unsigned int i = 0; i < face.nCorners(); ++i)
+  {
+    worldCorners_[index*cube_corners + i] = coords_[face.corners[i].idx].coord;
+    localCorners_[index*cube_corners + i] = re.position(face.corners[i].num,dim);
+  }
+}
+
+
+template<typename GV, int cd>
+void Extractor<GV,cd>::reorderSpatially()
+{
+  typedef Dune::GridGlue::MortonCurve<ctype, dimworld> Curve;
+  typedef std::pair<typename Curve::Key, unsigned int> KeyPair;
+
+  // the curve runs through the bounding box of the patch
+  std::vector<Coords> points(coords_.size());
+  for (unsigned int i = 0; i < coords_.size(); ++i)
+    points[i] = coords_[i].coord;
+  const Curve curve(points);
+
+  // sort the vertices along the curve...
+  std::vector<KeyPair> keys(coords_.size());
+  for (unsigned int i = 0; i < coords_.size(); ++i)
+    keys[i] = std::make_pair(curve.key(points[i]), i);
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<unsigned int> vertexIndex(coords_.size());
+  std::vector<CoordinateInfo> coords(coords_.size());
+  std::vector<VertexInfo> vertices;
+  vertices.reserve(vertices_.size());
+  for (unsigned int i = 0; i < keys.size(); ++i)
+  {
+    const unsigned int old = keys[i].second;
+    vertexIndex[old] = i;
+    coords[i] = coords_[old];
+    coords[i].index = i;
+    vertices.push_back(vertices_[old]);
+    vertices.back().idx = i;
+    vertexTable_[coords[i].vtxindex] = i;
+  }
+  coords_.swap(coords);
+  vertices_.swap(vertices);
+
+  // ...and renumber the corners of the subentities
+  for (unsigned int i = 0; i < subEntities_.size(); ++i)
+    for (unsigned int j = 0; j < subEntities_[i].nCorners(); ++j)
+      subEntities_[i].corners[j].idx = vertexIndex[subEntities_[i].corners[j].idx];
+
+  // sort the elements by the center of their subentities, the subentities
+  // of an element stay together
+  keys.resize(elements_.size());
+  for (unsigned int e = 0; e < elements_.size(); ++e)
+  {
+    Coords center(0);
+    unsigned int nCorners = 0;
+    for (unsigned int f = elements_[e].idx; f < elements_[e].idx + elements_[e].faces; ++f)
+      for (unsigned int j = 0; j < subEntities_[f].nCorners(); ++j, ++nCorners)
+        center += coords_[subEntities_[f].corners[j].idx].coord;
+    center /= nCorners;
+    keys[e] = std::make_pair(curve.key(center), e);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<SubEntityInfo> subEntities;
+  subEntities.reserve(subEntities_.size());
+  std::vector<ElementInfo> elements;
+  elements.reserve(elements_.size());
+  for (unsigned int i = 0; i < keys.size(); ++i)
+  {
+    const ElementInfo & info = elements_[keys[i].second];
+    elements.push_back(info);
+    elements.back().idx = subEntities.size();
+    for (unsigned int f = info.idx; f < info.idx + info.faces; ++f)
+      subEntities.push_back(subEntities_[f]);
+    elementTable_[subEntities.back().parent] = i;
+  }
+  subEntities_.swap(subEntities);
+  elements_.swap(elements);
+}
+
+
+template<typename GV, int cd>
+void Extractor<GV,cd>::finishIncrementalUpdate(const std::vector<char>& removed,
+                                               const std::deque<SubEntityInfo>& temp_faces)
+{
+  const unsigned int nOld = subEntities_.size();
+  ++topologyRevision_;
+  ++coordinateRevision_;
+
+  // the new index of each previous and each extracted subentity, -1 if it is dropped
+  std::vector<int> faceIndex(nOld + temp_faces.size(), -1);
+  unsigned int n = 0;
+  for (unsigned int i = 0; i < nOld; ++i)
+    if (!removed[i])
+      faceIndex[i] = n++;
+  for (unsigned int i = 0; i < temp_faces.size(); ++i)
+    faceIndex[nOld + i] = n++;
+
+  // the extracted elements may have been moved, so get the coordinates of their
+  // vertices again and remember which ones have changed
+  std::vector<char> moved(coords_.size(), 0);
+  std::vector<char> visited(coords_.size(), 0);
+  for (typename std::deque<SubEntityInfo>::const_iterator it = temp_faces.begin(); it != temp_faces.end(); ++it)
+    for (unsigned int j = 0; j < it->nCorners(); ++j)
+    {
+      const unsigned int v = it->corners[j].idx;
+      if (visited[v])
+        continue;
+      visited[v] = 1;
+      const Coords coord = gv_.grid().entityPointer(vertices_[v].s)->geometry().corner(0);
+      moved[v] = (coord != coords_[v].coord);
+      coords_[v].coord = coord;
+    }
+
+  // keep the subentities that have not been detached, followed by the extracted ones
+  std::vector<SubEntityInfo> subEntities(n);
+  std::vector<Coords> worldCorners(n * cube_corners);
+  std::vector<LocalCoords> localCorners(n * cube_corners);
+  previousIndex_.assign(n, -1);
+  for (unsigned int i = 0; i < nOld; ++i)
+  {
+    if (faceIndex[i] < 0)
+      continue;
+    const unsigned int k = faceIndex[i];
+    subEntities[k] = subEntities_[i];
+    std::copy(worldCorners_.begin() + i*cube_corners, worldCorners_.begin() + (i+1)*cube_corners,
+              worldCorners.begin() + k*cube_corners);
+    std::copy(localCorners_.begin() + i*cube_corners, localCorners_.begin() + (i+1)*cube_corners,
+              localCorners.begin() + k*cube_corners);
+
+    bool touched = false;
+    for (unsigned int j = 0; j < subEntities[k].nCorners(); ++j)
+      touched = touched || moved[subEntities[k].corners[j].idx];
+    if (!touched)
+      previousIndex_[k] = i;
+  }
+  std::copy(temp_faces.begin(), temp_faces.end(), subEntities.begin() + (n - temp_faces.size()));
+  subEntities_.swap(subEntities);
+  worldCorners_.swap(worldCorners);
+  localCorners_.swap(localCorners);
+  nPreviousSubEntities_ = nOld;
+
+  // keep the elements that have not been detached, in the order of their first subentity
+  std::vector<ElementInfo> elements;
+  elements.reserve(elements_.size());
+  for (typename std::vector<ElementInfo>::const_iterator it = elements_.begin(); it != elements_.end(); ++it)
+  {
+    if (faceIndex[it->idx] < 0)
+      continue;
+    elements.push_back(*it);
+    elements.back().idx = faceIndex[it->idx];
+    elementTable_[subEntities_[elements.back().idx].parent] = elements.size() - 1;
+  }
+  elements_.swap(elements);
+
+  // drop the vertices that are no longer used and renumber the others
+  std::vector<int> vertexIndex(coords_.size(), -1);
+  for (unsigned int i = 0; i < n; ++i)
+    for (unsigned int j = 0; j < subEntities_[i].nCorners(); ++j)
+      vertexIndex[subEntities_[i].corners[j].idx] = 0;
+
+  unsigned int nVertices = 0;
+  for (unsigned int v = 0; v < coords_.size(); ++v)
+  {
+    if (vertexIndex[v] < 0)
+    {
+      vertexTable_[coords_[v].vtxindex] = -1;
+      continue;
+    }
+    vertexIndex[v] = nVertices;
+    coords_[nVertices] = coords_[v];
+    coords_[nVertices].index = nVertices;
+    vertices_[nVertices] = vertices_[v];
+    vertices_[nVertices].idx = nVertices;
+    vertexTable_[coords_[nVertices].vtxindex] = nVertices;
+    ++nVertices;
+  }
+  coords_.erase(coords_.begin() + nVertices, coords_.end());
+  vertices_.erase(vertices_.begin() + nVertices, vertices_.end());
+
+  for (unsigned int i = 0; i < n; ++i)
+    for (unsigned int j = 0; j < subEntities_[i].nCorners(); ++j)
+      subEntities_[i].corners[j].idx = vertexIndex[subEntities_[i].corners[j].idx];
+
+  // the corners of the changed subentities
+  for (unsigned int i = 0; i < n; ++i)
+    if (previousIndex_[i] < 0)
+      computeCorners(i);
+
+  // keep the keys up to date for the next complete update
+  if (trackChanges_)
+  {
+    SubEntityKeys keys(n);
+    for (unsigned int i = 0; i < n; ++i)
+      if (previousIndex_[i] >= 0 && std::size_t(previousIndex_[i]) < subEntityKeys_.size())
+        keys[i] = subEntityKeys_[previousIndex_[i]];
+      else
+        keys[i] = subEntityKey(i);
+    subEntityKeys_.swap(keys);
+  }
+}
+
+
+/** \brief Get World geometry of the extracted face */
+template<typename GV, int cd>
+typename Extractor<GV,cd>::Geometry Extractor<GV,cd>::geometry(unsigned int index) const
+{
+  Dune::array<Coords, cube_corners> corners;
+  for (unsigned int i = 0; i < subEntities_[index].nCorners(); ++i)
+    corners[i] = worldCorners_[index*cube_corners + i];
+
+  return Geometry(subEntities_[index].geometryType_, corners);
+}
+
+
+/** \brief Get Geometry of the extracted face in element coordinates */
+template<typename GV, int cd>
+typename Extractor<GV,cd>::LocalGeometry Extractor<GV,cd>::geometryLocal(unsigned int index) const
+{
+  Dune::array<LocalCoords, cube_corners> corners;
   for (unsigned int i = 0; i < subEntities_[index].nCorners(); ++i)
-    corners[i] = re.position(face.corners[i].num,dim);
+    corners[i] = localCorners_[index*cube_corners + i];
 
-  return LocalGeometry(facetype, corners);
+  return LocalGeometry(subEntities_[index].geometryType_, corners);
 }
 
 #endif // DUNE_EXTRACTOR_HH
@@ -19,7 +19,14 @@
 #ifndef EXTRACTOR_PREDICATES_HH
 #define EXTRACTOR_PREDICATES_HH
 
+#include <cstddef>
+#include <vector>
+
 /** \brief Base class for subentity-selecting predicates
+
+    Codim0Extractor and Codim1Extractor also accept any callable instead of a
+    class derived from this one, which avoids the virtual call per subentity.
+
     \tparam GV GridView that the subentities are extracted from
  */
 template<typename GV, int codim>
@@ -37,4 +44,49 @@ public:
   virtual ~ExtractorPredicate() {}
 };
 
+/** \brief Predicate selecting the boundary faces with given boundary ids
+
+    Codim1Extractor evaluates it directly on the boundary intersections,
+    so no virtual function is called per face.
+ */
+class BoundaryIdPredicate
+{
+public:
+
+  /** \brief Select the faces with boundary id id */
+  explicit BoundaryIdPredicate(int id)
+  {
+    insert(id);
+  }
+
+  /** \brief Select the faces with any of the given boundary ids */
+  explicit BoundaryIdPredicate(const std::vector<int>& ids)
+  {
+    for (std::size_t i = 0; i < ids.size(); ++i)
+      insert(ids[i]);
+  }
+
+  /** \brief Return true if the boundary intersection is to be extracted */
+  template<class Intersection>
+  bool operator() (const Intersection& is) const
+  {
+    const int id = is.boundaryId();
+    return id >= 0 && std::size_t(id) < selected_.size() && selected_[id];
+  }
+
+private:
+
+  void insert(int id)
+  {
+    if (id < 0)
+      return;
+    if (std::size_t(id) >= selected_.size())
+      selected_.resize(id+1, false);
+    selected_[id] = true;
+  }
+
+  /// @brief selected_[id] is true if faces with the boundary id are extracted
+  std::vector<bool> selected_;
+};
+
 #endif // EXTRACTOR_PREDICATES_HH
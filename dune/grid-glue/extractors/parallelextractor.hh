@@ -1,6 +1,5 @@
 // -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
 // vi: set et ts=4 sw=2 sts=2:
-#error Don't use this header anymore!
 /*
  *  Filename:    parallelextractor.hh
  *  Version:     1.0
@@ -20,70 +19,110 @@
 #ifndef DUNE_PARALLEL_EXTRACTOR_HH
 #define DUNE_PARALLEL_EXTRACTOR_HH
 
-#error ParallelExtractor should not be use atm
-
 #include <vector>
-#include <deque>
-#include <map>
-#include <set>
 #include <algorithm>
+
 #include <dune/common/exceptions.hh>
-#include <dune/common/fvector.hh>
-#include <dune/common/array.hh>
-#include <dune/grid/common/geometry.hh>
+#include <dune/common/typetraits.hh>
+#include <dune/grid/common/datahandleif.hh>
+#include <dune/grid/common/gridenums.hh>
+
+#include "extractorpredicate.hh"
+
+/**
+ * @brief restrict a predicate to the interior elements
+ *
+ * Subentities of elements in the overlap or ghost partition are extracted
+ * by the process owning the element, so each subentity of a distributed
+ * grid belongs to exactly one local patch.
+ */
+template<typename GV, int codim>
+class InteriorExtractorPredicate : public ExtractorPredicate<GV,codim>
+{
+public:
+  InteriorExtractorPredicate(const ExtractorPredicate<GV,codim>& descr)
+    : descr_(descr)
+  {}
 
-#include <dune/common/collectivecommunication.hh>
-#include <stdlib.h>
+  virtual bool contains(const typename GV::Traits::template Codim<0>::EntityPointer& element, unsigned int subentity) const
+  {
+    return element->partitionType() == Dune::InteriorEntity
+           && descr_.contains(element, subentity);
+  }
 
-#if HAVE_MPI
-#include <dune/common/mpicollectivecommunication.hh>
-#endif
+private:
+  const ExtractorPredicate<GV,codim>& descr_;
+};
 
-template <typename COMM>
-class CommHelper
+/**
+ * @brief restrict a callable predicate to the interior elements
+ *
+ * Works for the callables of both local extractors, taking the element or
+ * the element and the boundary intersection.
+ */
+template<typename Predicate>
+class InteriorCallable
 {
 public:
-  CommHelper (const COMM & c) {}
+  InteriorCallable(const Predicate& descr)
+    : descr_(descr)
+  {}
 
-  template<typename BUF>
-  void allgather(const BUF & in, BUF & out, int)
+  template<class Element>
+  bool operator() (const Element& element) const
   {
-    out = in;
+    return element.partitionType() == Dune::InteriorEntity && descr_(element);
   }
+
+  template<class Element, class Intersection>
+  bool operator() (const Element& element, const Intersection& is) const
+  {
+    return element.partitionType() == Dune::InteriorEntity && descr_(element, is);
+  }
+
+private:
+  const Predicate& descr_;
 };
 
-#if HAVE_MPI
-template <>
-class CommHelper< Dune::CollectiveCommunication<MPI_Comm> >
+/**
+ * @brief restrict a BoundaryIdPredicate to the boundary faces of interior elements
+ */
+class InteriorBoundaryIds
 {
-  typedef Dune::CollectiveCommunication<MPI_Comm> COMM;
-  const COMM & comm;
 public:
-  CommHelper (const COMM & c) : comm(c) {}
+  InteriorBoundaryIds(const BoundaryIdPredicate& descr)
+    : descr_(descr)
+  {}
 
-  template<typename BUF>
-  void allgather(BUF & in, BUF & out, int outsz)
+  template<class Element, class Intersection>
+  bool operator() (const Element& element, const Intersection& is) const
   {
-    typedef typename BUF::value_type V;
-    MPI_Allgather(&in[0], in.size(),
-                  Dune::MPITraits<V>::getType(),
-                  &out[0], outsz,
-                  Dune::MPITraits<V>::getType(), comm);
+    return element.partitionType() == Dune::InteriorEntity && descr_(is);
   }
+
+private:
+  const BoundaryIdPredicate& descr_;
 };
-#endif
 
 /**
- * @brief provides static methods for grid surface extraction
+ * @brief extractor for distributed grids
  *
- * Provides methods that build topology information for given grids.
-
-   \tparam GV the grid view type
+ * Each process extracts the subentities of its interior elements with the local
+ * extractor LX, so the local patches do not overlap.  Vertices on the boundary
+ * between two local patches are identified by their global id: for each vertex of
+ * the local patch the ranks whose patches contain the same vertex are determined,
+ * by communicating with the neighbouring processes of the grid only.
+ *
+ * Apart from that, ParallelExtractor behaves like LX and can be used as patch of
+ * a GridGlue.  All overloads of update() and refreshCoordinates() are wrapped, so
+ * that the restriction to the interior elements and the shared vertices are kept
+ * up to date; each of them has to be called by all processes of the grid.
+ *
+ * \tparam LX the local extractor, Codim0Extractor or Codim1Extractor
  */
 template<typename LX>
-class ParallelExtractor
+class ParallelExtractor : public LX
 {
-  /** \todo This should rather be protected */
 public:
 
   typedef LX LocalExtractor;
@@ -91,472 +130,270 @@ public:
   // retrieve typedefs etc. from LocalExtractor
   enum { dimworld = LX::dimworld };
   enum { dim      = LX::dim };
-  enum { dimw     = LX::dimworld };
   enum { codim    = LX::codim };
 
-  typedef typename LX::GridView GV;
   typedef typename LX::GridView GridView;
-  typedef typename LX::Coords Coords;
+  typedef typename GridView::Grid Grid;
 
-  typedef typename GV::Grid Grid;
-  typedef typename GV::Grid::ctype ctype;
-  typedef typename LX::VertexVector VertexVector;
+  /// @brief the global id of a vertex
+  typedef typename Grid::GlobalIdSet::IdType GlobalId;
 
-  typedef typename GV::Traits::template Codim<dim>::EntityPointer VertexPtr;
-  typedef typename GV::Traits::template Codim<dim>::Entity Vertex;
+  typedef typename Grid::template Codim<0>::EntitySeed ElementSeed;
 
-  typedef typename GV::Traits::template Codim<0>::EntityPointer ElementPtr;
-  typedef typename GV::Traits::template Codim<0>::Entity Element;
-  typedef typename GV::Traits::template Codim<0>::Iterator ElementIter;
-
-  // index sets and index types
-  typedef typename GV::IndexSet IndexSet;
-  typedef typename IndexSet::IndexType IndexType;
-
-  typedef typename GV::Grid::GlobalIdSet::IdType GlobalId;
-  typedef std::pair<GlobalId, size_t>                              GlobalFaceId;
-
-  typedef typename LX::Geometry Geometry;
-  typedef typename LX::LocalGeometry LocalGeometry;
+private:
 
-  // types for the global setup
-  struct GlobalCoordInfo
+  /** \brief tell the neighbouring processes which vertices are in the local patch */
+  class SharedVertexDataHandle
+    : public Dune::CommDataHandleIF<SharedVertexDataHandle, int>
   {
-    Coords c;
-    GlobalId i;
-    bool valid;
+  public:
+    SharedVertexDataHandle(ParallelExtractor& extractor, int rank)
+      : extractor_(extractor), rank_(rank)
+    {}
 
-    GlobalCoordInfo() : valid(false) {}
+    bool contains (int dim, int codim) const
+    {
+      return codim == dim;
+    }
 
-    bool operator < (const GlobalCoordInfo & other) const
+    bool fixedsize (int dim, int codim) const
     {
-      return valid && (!other.valid || i < other.i);
-      if (!valid) return false;
-      if (!other.valid) return true;
-      return i < other.i;
+      return true;
     }
 
-    bool operator == (const GlobalCoordInfo & other) const
+    template<class EntityType>
+    size_t size (const EntityType& e) const
     {
-      return (! valid && ! other.valid) || (valid && other.valid && i == other.i);
+      return 1;
     }
-  };
-  // typedef std::vector<GlobalId> GlobalEntityTopology;
-  struct GlobalFaceInfo
-  {
-    // GlobalEntityTopology v;
-    GlobalId v[(1<<(dim-codim))];
-    char corners;
-    GlobalFaceId i;
-    bool valid;
 
-    GlobalFaceInfo() : valid(false) {}
+    template<class MessageBuffer, class EntityType>
+    void gather (MessageBuffer& buff, const EntityType& e) const
+    {
+      buff.write(patchVertex(e) >= 0 ? rank_ : -1);
+    }
 
-    bool operator < (const GlobalFaceInfo & other) const
+    template<class MessageBuffer, class EntityType>
+    void scatter (MessageBuffer& buff, const EntityType& e, size_t n)
     {
-      if (!valid) return false;
-      if (!other.valid) return true;
-      return i < other.i;
+      int rank;
+      buff.read(rank);
+      const int v = patchVertex(e);
+      if (rank >= 0 && rank != rank_ && v >= 0)
+        extractor_.sharingRanks_[v].push_back(rank);
     }
 
-    bool operator == (const GlobalFaceInfo & other) const
+  private:
+    template<class EntityType>
+    int patchVertex (const EntityType& e) const
     {
-      return (! valid && ! other.valid) || (valid && other.valid && i == other.i);
+      return extractor_.patchVertex_[extractor_.gridView().indexSet().index(e)];
     }
+
+    ParallelExtractor& extractor_;
+    const int rank_;
   };
 
-private:
+  /// @brief the patch vertex for each vertex of the grid view, -1 if it is not in the patch
+  std::vector<int> patchVertex_;
 
-  const GV& gv_;
-  LX lx_;
-  // map between local and global _face_ index
-  std::vector<unsigned int>  local2global_;
-  std::vector<unsigned int>  global2local_;
-  // global data
-  std::vector<Coords> coords_;
-  std::vector<VertexVector> faces_;
-  std::vector<Dune::GeometryType> geometryTypes_;
-
-  Dune::GeometryType guessGeomType(int corners) const
-  {
-    Dune::GeometryType type;
-    switch (dim-codim)
-    {
-    case 0 :
-      type.makeVertex();
-      break;
-    case 1 :
-      type.makeLine();
-      break;
-    case 2 :
-      switch (corners) {
-      case 3 :
-        type.makeTriangle();
-        break;
-      case 4 :
-        type.makeQuadrilateral();
-        break;
-      default :
-        DUNE_THROW(Dune::Exception,
-                   "impossible intersection (dim=" <<
-                   dim-codim << ", " << corners << " corners)");
-      }
-      break;
-    case 3 :
-      switch (corners) {
-      case 4 :
-        type.makeTetrahedron();
-        break;
-      case 5 :
-        type.makePyramid();
-        break;
-      case 6 :
-        type.makePrism();
-        break;
-      case 8 :
-        type.makeHexahedron();
-        break;
-      default :
-        DUNE_THROW(Dune::Exception,
-                   "impossible intersection (dim=" <<
-                   dim-codim << ", " << corners << " corners)");
-      }
-      break;
-    default :
-      DUNE_THROW(Dune::NotImplemented,
-                 "Only intersections up to dim=3 are supported");
-    }
-    return type;
-  }
+  /// @brief the global id of each patch vertex
+  std::vector<GlobalId> globalIds_;
 
-public:
+  /// @brief the other ranks whose patches contain the vertex, for each patch vertex
+  std::vector<std::vector<int> > sharingRanks_;
+
+  /// @brief the ranks sharing at least one vertex with the local patch
+  std::vector<int> neighborRanks_;
+
+  /// @brief the topology revision of the local patch the tables above belong to
+  unsigned long sharedVerticesRevision_;
+
+  /** \brief find the ranks sharing the patch vertices */
+  void computeSharedVertices();
 
-  // methods
-  bool contains (unsigned int global, unsigned int & local) const
+  /** \brief find the ranks sharing the patch vertices if the patch of any rank has changed since */
+  void updateSharedVertices()
   {
-    local = global2local_[global];
-    // assert(local == global);
-    return (local != (unsigned int)(-1));
+    const int stale = (this->topologyRevision() != sharedVerticesRevision_);
+    if (this->gridView().comm().max(stale))
+      computeSharedVertices();
   }
 
+public:
+
   /*  C O N S T R U C T O R S   A N D   D E S T R U C T O R S  */
 
   /**
    * @brief Constructor
    * @param gv the grid view object to work with
+   * @param descr the predicate selecting the subentities, it is restricted to the interior elements
    */
-  ParallelExtractor(const GV& gv, const ExtractorPredicate<GV,codim>& descr)
-    :  gv_(gv), lx_(gv, descr)
-  {
-    update(descr);
-  }
-
-  /** \brief Destructor frees allocated memory */
-  ~ParallelExtractor()
+  ParallelExtractor(const GridView& gv, const ExtractorPredicate<GridView,codim>& descr)
+    : LX(gv, InteriorExtractorPredicate<GridView,codim>(descr))
   {
-    clear();
+    computeSharedVertices();
   }
 
   /*  F U N C T I O N A L I T Y  */
 
   /**
-   * @brief delete everything build up so far and free the memory
+   * @brief extract the local patch again, e.g. after the grid has been adapted
+   *
+   * All processes of the grid have to call this method.
    */
-  void clear()
+  void update(const ExtractorPredicate<GridView,codim>& descr)
   {
-    lx_.clear();
-    global2local_.clear();
+    LX::update(InteriorExtractorPredicate<GridView,codim>(descr));
+    computeSharedVertices();
   }
 
-  const GridView & gridView() const
+  /**
+   * @brief extract the local patch again, selecting the subentities with a callable
+   * @param descr a callable as accepted by LX, it is restricted to the interior elements
+   */
+  template<class Predicate>
+  typename Dune::enable_if<!Dune::IsBaseOf<ExtractorPredicate<GridView,codim>, Predicate>::value>::type
+  update(const Predicate& descr)
   {
-    return gv_;
+    LX::update(InteriorCallable<Predicate>(descr));
+    computeSharedVertices();
   }
 
-private:
-  void update(const ExtractorPredicate<GV,codim>& descr)
+  /**
+   * @brief extract the boundary faces with the given boundary ids again, only for Codim1Extractor
+   */
+  void update(const BoundaryIdPredicate& descr)
   {
-    // obtain local data
-    std::vector<GlobalCoordInfo> localCoordInfos;
-    std::vector<GlobalFaceInfo> localFaceInfos;
-    std::vector<Dune::GeometryType> localGeometryTypes;
-
-    // get vertex data
-    {
-      std::vector<Coords> coords;
-      lx_.getCoords(coords);
-      localCoordInfos.resize(coords.size());
-      for (size_t i=0; i<coords.size(); i++)
-      {
-        localCoordInfos[i].c = coords[i];
-        localCoordInfos[i].i = gv_.grid().globalIdSet().id(* lx_.vertex(i));
-        localCoordInfos[i].valid = true;
-      }
-    }
-
-    // get face data
-    {
-      std::vector<VertexVector> faces;
-      lx_.getFaces(faces);
-      localFaceInfos.resize(faces.size());
-      size_t Xsub = 0;
-      for (size_t i=0; i<faces.size(); i++)
-      {
-        size_t corners = faces[i].size();
-        // localFaceInfos[i].v.resize(corners);
-        localFaceInfos[i].corners = corners;
-        for (size_t v=0; v<corners; v++)
-        {
-          localFaceInfos[i].v[v] = localCoordInfos[faces[i][v]].i;
-        }
-        localFaceInfos[i].i.first = gv_.grid().globalIdSet().id(* lx_.element(i));
-        if (i>0 && localFaceInfos[i].i.first != localFaceInfos[i-1].i.first)
-          Xsub = 0;
-        localFaceInfos[i].i.second = Xsub++;
-        localFaceInfos[i].valid = true;
-      }
-    }
-
-    // merge parallel data
-    std::vector<GlobalCoordInfo> globalCoordInfos;
-    std::vector<GlobalFaceInfo>  globalFaceInfos;
-    std::vector<Dune::GeometryType> globalGeometryTypes;
-
-    // communicate coordinates
-    // TODO: use more efficient communication
-    typedef typename Grid::CollectiveCommunication Comm;
-    const Comm & comm = gv_.grid().comm();
-    CommHelper<Comm> commHelper(comm);
-
-    size_t globalCoordLocalSize = localCoordInfos.size();
-    globalCoordLocalSize = comm.max(globalCoordLocalSize) + 2;
-    size_t globalCoordSize = globalCoordLocalSize * comm.size();;
-    globalCoordInfos.resize(globalCoordSize);
-    commHelper.allgather(localCoordInfos, globalCoordInfos, globalCoordLocalSize);
-
-    // communicate faces
-    // TODO: use more efficient communication
-    size_t globalFaceLocalSize = localFaceInfos.size();
-    globalFaceLocalSize = comm.max(globalFaceLocalSize);
-    size_t globalFaceSize = globalFaceLocalSize * comm.size();
-    globalFaceInfos.resize(globalFaceSize);
-    commHelper.allgather(localFaceInfos, globalFaceInfos, globalFaceLocalSize);
-
-    // sort and shrink coordinate vector
-    std::sort(globalCoordInfos.begin(), globalCoordInfos.end());
-    {
-      typename std::vector<GlobalCoordInfo>::iterator where =
-        std::unique(globalCoordInfos.begin(), globalCoordInfos.end());
-      --where;
-      while(where->valid == false) --where;
-      ++where;
-      globalCoordInfos.erase(where, globalCoordInfos.end());
-    }
-    assert(globalCoordInfos.size() > 0);
-    assert(globalCoordInfos.front().valid == true);
-    globalCoordSize = globalCoordInfos.size();
-
-    // sort and shrink face vector
-    std::sort(globalFaceInfos.begin(), globalFaceInfos.end());
-    {
-      typename std::vector<GlobalFaceInfo>::iterator where =
-        std::unique(globalFaceInfos.begin(), globalFaceInfos.end());
-      --where;
-      while(where->valid == false) --where;
-      ++where;
-      globalFaceInfos.erase(where, globalFaceInfos.end());
-    }
-    globalFaceSize = globalFaceInfos.size();
-
-    // sort and shrink geometry types vector
-    std::sort(globalGeometryTypes.begin(), globalGeometryTypes.end());
-    {
-      typename std::vector<Dune::GeometryType>::iterator where =
-        std::unique(globalGeometryTypes.begin(), globalGeometryTypes.end());
-      globalGeometryTypes.erase(where, globalGeometryTypes.end());
-    }
-    geometryTypes_ = globalGeometryTypes;
-
-    // setup parallel coords and faces
-    {
-      std::map<GlobalId, unsigned int> coordIndex;       // quick access to vertex index, give an ID
-      coords_.resize(globalCoordSize);
-      faces_.resize(globalFaceSize);
-
-      for (size_t c=0; c<globalCoordSize; ++c)
-      {
-        coordIndex[globalCoordInfos[c].i] = c;
-        coords_[c] = globalCoordInfos[c].c;
-      }
-
-      for (size_t f=0; f<globalFaceSize; ++f)
-      {
-        // size_t corners = globalFaceInfos[f].v.size();
-        size_t corners = globalFaceInfos[f].corners;
-        faces_[f].resize(corners);
-        for (size_t c=0; c<corners; ++c)
-          faces_[f][c] = coordIndex[globalFaceInfos[f].v[c]];
-      }
-    }
-
-    // setup local/global mappings
-    {
-      // create a temporary map for quick lookup
-      std::map<GlobalFaceId, unsigned int> globalIndex;
-      for (size_t f=0; f<globalFaceInfos.size(); ++f)
-      {
-        globalIndex[globalFaceInfos[f].i] = f;
-      }
-      // "copy" map to _local2global
-      local2global_.resize(localFaceInfos.size());
-      for (size_t i = 0; i<localFaceInfos.size(); i++)
-      {
-        local2global_[i] = globalIndex[localFaceInfos[i].i];
-      }
-    }
-    {
-      // create a temporary map for quick lookup
-      std::map<GlobalFaceId, unsigned int> localIndex;
-      for (size_t f=0; f<localFaceInfos.size(); ++f)
-      {
-        localIndex[localFaceInfos[f].i] = f;
-      }
-      // "copy" map to _global2local
-      // not all entries are contained in the map, if not the entry is "-1"
-      global2local_.resize(globalFaceInfos.size());
-      for (size_t i = 0; i<globalFaceInfos.size(); i++)
-      {
-        typename std::map<GlobalFaceId, unsigned int>::iterator where =
-          localIndex.find(globalFaceInfos[i].i);
-        if (where != localIndex.end())
-          global2local_[i] = where->second;
-        else
-          global2local_[i] = (unsigned int)-1;
-      }
-    }
-
-  };
-
-public:
-
-  /*  G E T T E R S  */
+    LX::update(InteriorBoundaryIds(descr));
+    computeSharedVertices();
+  }
 
   /**
-   * @brief getter for the coordinates array
-   * @param coords a vector that will be resized (!) and filled with the coordinates,
-   * note that the single components are written consecutively
+   * @brief update the local patch for a set of changed elements only
+   *
+   * See the incremental update() of LX.  The shared vertices are determined again.
    */
-  void getCoords(std::vector<Dune::FieldVector<ctype, dimworld> >& coords) const
+  void update(const ExtractorPredicate<GridView,codim>& descr, const std::vector<ElementSeed>& changed)
   {
-    coords.resize(coords_.size());
-    std::copy(coords_.begin(), coords_.end(), coords.begin());
+    LX::update(InteriorExtractorPredicate<GridView,codim>(descr), changed);
+    computeSharedVertices();
   }
 
-
   /**
-   * @brief getter for the count of coordinates
-   * @return the count
+   * @brief update the local patch for a set of changed elements only, selecting the subentities with a callable
    */
-  unsigned int nCoords() const
+  template<class Predicate>
+  typename Dune::enable_if<!Dune::IsBaseOf<ExtractorPredicate<GridView,codim>, Predicate>::value>::type
+  update(const Predicate& descr, const std::vector<ElementSeed>& changed)
   {
-    return coords_.size();
+    LX::update(InteriorCallable<Predicate>(descr), changed);
+    computeSharedVertices();
   }
 
   /**
-   * @brief Get the list of geometry types
+   * @brief update the boundary faces with the given boundary ids for a set of changed elements only
    */
-  void getGeometryTypes(std::vector<Dune::GeometryType>& geometryTypes) const
+  void update(const BoundaryIdPredicate& descr, const std::vector<ElementSeed>& changed)
   {
-    geometryTypes.resize(faces_.size());
-    for (size_t i=0; i<faces_.size(); i++)
-      geometryTypes[i] = guessGeomType(faces_[i].size());
+    LX::update(InteriorBoundaryIds(descr), changed);
+    computeSharedVertices();
   }
 
   /**
-   * @brief getter for the indices array
-   * It is strongly recommended not to modify its contents.
-   * Deallocation is done in this class.
-   * @return the _indices array
+   * @brief read the vertex positions from the grid again, keeping the subentities
+   *
+   * The vertices of the patch stay the same, so the shared vertices are only
+   * determined again if the patch has been changed through the interface of LX.
    */
-  void getFaces(std::vector<VertexVector>& faces) const
+  void refreshCoordinates()
   {
-    faces.resize(this->faces_.size());
-    for (size_t i = 0; i < this->faces_.size(); ++i)
-      faces[i] = this->faces_[i];
+    LX::refreshCoordinates();
+    updateSharedVertices();
   }
 
-
   /**
-   * @brief gets index of first face as well as the total number of faces that
-   * were extracted from this element
-   * @param e the element
-   * @param first will contain the first index if found, else -1
-   * @param count will contain the number of faces if found, else 0
-   * @return success
+   * @brief read the vertex positions from the grid again and transform them, keeping the subentities
    */
-  bool faceIndices(const Element& e, int& first, int& count) const
+  template<class Transform>
+  void refreshCoordinates(const Transform& transform)
   {
-    if (lx_.faceIndices(e, first, count))
-    {
-      // convert local index to global index
-      first = local2global_[first];
-      return true;
-    }
-    return false;
+    LX::refreshCoordinates(transform);
+    updateSharedVertices();
   }
 
+  /*  G E T T E R S  */
 
   /**
-   * @brief gets the number face in the parent element
-   * @param index the index of the face
-   * @return if failed -1, else the index
+   * @brief the global id of a vertex of the local patch
    */
-  int indexInInside(unsigned int index) const
+  const GlobalId & globalVertexId(unsigned int index) const
   {
-    unsigned int l_index = 0;
-    bool have = contains(index, l_index);
-    assert(have);
-    return lx_.indexInInside(l_index);
+    return globalIds_[index];
   }
 
+  /**
+   * @brief the other ranks whose local patches contain the vertex
+   * @param index the index of the vertex in the local patch
+   */
+  const std::vector<int> & sharingRanks(unsigned int index) const
+  {
+    return sharingRanks_[index];
+  }
 
   /**
-   * @brief gets the parent element for a given face index,
-   * throws an exception if index not valid
-   * @param index the index of the face
-   * @return a reference to the element's stored pointer
+   * @brief whether the vertex is also contained in the patch of another rank
    */
-  const ElementPtr& element(unsigned int index) const
+  bool isShared(unsigned int index) const
   {
-    unsigned int l_index = 0;
-    bool have = contains(index, l_index);
-    assert(have);
-    return lx_.element(l_index);
+    return !sharingRanks_[index].empty();
   }
 
-  /** \brief Get World geometry of the extracted face */
-  Geometry geometry(unsigned int index) const
+  /**
+   * @brief the ranks whose local patches share vertices with the local patch, sorted
+   */
+  const std::vector<int> & neighborRanks() const
   {
-    unsigned int l_index = 0;
-    bool have = contains(index, l_index);
-    assert(have);
-    return lx_.geometry(l_index);
+    return neighborRanks_;
   }
+};
 
-  /** \brief Get Geometry of the extracted face in element coordinates */
-  Geometry geometryLocal(unsigned int index) const
+template<typename LX>
+void ParallelExtractor<LX>::computeSharedVertices()
+{
+  const GridView & gv = this->gridView();
+  const unsigned int nVertices = this->nCoords();
+
+  sharedVerticesRevision_ = this->topologyRevision();
+
+  patchVertex_.assign(gv.size(dim), -1);
+  globalIds_.resize(nVertices);
+  sharingRanks_.assign(nVertices, std::vector<int>());
+  neighborRanks_.clear();
+
+  for (unsigned int i = 0; i < nVertices; ++i)
   {
-    unsigned int l_index = 0;
-    bool have = contains(index, l_index);
-    assert(have);
-    return lx_.geometryLocal(l_index);
+    const typename LX::VertexPtr & vertex = this->vertex(i);
+    patchVertex_[gv.indexSet().index(*vertex)] = i;
+    globalIds_[i] = gv.grid().globalIdSet().id(*vertex);
   }
 
-  // export codim0 method
-  bool & positiveNormalDirection()
+  if (gv.comm().size() == 1)
+    return;
+
+  // only the copies of the vertices on the process borders are exchanged
+  SharedVertexDataHandle dataHandle(*this, gv.comm().rank());
+  gv.communicate(dataHandle, Dune::InteriorBorder_InteriorBorder_Interface, Dune::ForwardCommunication);
+
+  for (unsigned int i = 0; i < nVertices; ++i)
   {
-    return lx_.positiveNormalDirection();
+    std::vector<int> & ranks = sharingRanks_[i];
+    std::sort(ranks.begin(), ranks.end());
+    ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+    neighborRanks_.insert(neighborRanks_.end(), ranks.begin(), ranks.end());
   }
-};
+  std::sort(neighborRanks_.begin(), neighborRanks_.end());
+  neighborRanks_.erase(std::unique(neighborRanks_.begin(), neighborRanks_.end()), neighborRanks_.end());
+}
 
 #endif // DUNE_PARALLEL_EXTRACTOR_HH
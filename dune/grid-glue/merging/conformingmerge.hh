@@ -204,7 +204,7 @@ void ConformingMerge<dim, dimworld, T>::computeIntersection(const Dune::Geometry
 
       for (int j=0; j<dim+1; j++) {
         newSimplicialIntersection.grid1Local_[j] = refElement.position(subVertices[i][j],dim);
-        newSimplicialIntersection.grid2Local_[j] = refElement.position(subVertices[i][other[j]],dim);
+        newSimplicialIntersection.grid2Local_[j] = refElement.position(other[subVertices[i][j]],dim);
       }
 
       newSimplicialIntersection.grid1Entity_ = grid1Index;
@@ -218,7 +218,7 @@ void ConformingMerge<dim, dimworld, T>::computeIntersection(const Dune::Geometry
 
     // split the hexahedron into five tetrahedra
     // This can be removed if ever we allow RemoteIntersections that are not simplices
-    const unsigned int subVertices[5][4] = {{0,1,3,5}, {0,3,2,6}, {4,5,0,6}, {6,7,6,3}, {6,0,5,3}};
+    const unsigned int subVertices[5][4] = {{0,1,3,5}, {0,3,2,6}, {4,5,0,6}, {5,7,6,3}, {6,0,5,3}};
 
     for (int i=0; i<5; i++) {
 
@@ -226,7 +226,7 @@ void ConformingMerge<dim, dimworld, T>::computeIntersection(const Dune::Geometry
 
       for (int j=0; j<dim+1; j++) {
         newSimplicialIntersection.grid1Local_[j] = refElement.position(subVertices[i][j],dim);
-        newSimplicialIntersection.grid2Local_[j] = refElement.position(subVertices[i][other[j]],dim);
+        newSimplicialIntersection.grid2Local_[j] = refElement.position(other[subVertices[i][j]],dim);
       }
 
       newSimplicialIntersection.grid1Entity_ = grid1Index;
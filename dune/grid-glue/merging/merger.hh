@@ -4,7 +4,9 @@
 #define DUNE_MERGER_HH
 
 #include <vector>
+#include <utility>
 
+#include <dune/common/exceptions.hh>
 #include <dune/common/fvector.hh>
 #include <dune/geometry/type.hh>
 
@@ -118,6 +120,38 @@ public:
                      const std::vector<unsigned int>& grid2_elements,
                      const std::vector<Dune::GeometryType>& grid2_element_types) = 0;
 
+  /** \brief Whether this merger implements buildIncremental() */
+  virtual bool supportsIncrementalBuild() const
+  {
+    return false;
+  }
+
+  /**
+   * @brief compute only those intersections that are affected by a local change of the input grids
+   *
+   * The arguments are the same as for build(), plus flags marking the elements that are new or
+   * have changed since the previous build.  All intersections of pairs with at least one changed
+   * element are computed, the intersections between unchanged elements are assumed to be known
+   * by the caller.  After the call the merged grid consists of the newly computed intersections only.
+   *
+   * @param grid1_changed for each grid1 element: true if it is new or has changed
+   * @param grid2_changed for each grid2 element: true if it is new or has changed
+   * @param knownPairs pairs of (grid1, grid2) element indices whose intersections are still valid.
+   *        They are used to find starting points for the search of new intersections.
+   */
+  virtual void buildIncremental(const std::vector<Dune::FieldVector<ctype,dimworld> >& grid1_coords,
+                                const std::vector<unsigned int>& grid1_elements,
+                                const std::vector<Dune::GeometryType>& grid1_element_types,
+                                const std::vector<bool>& grid1_changed,
+                                const std::vector<Dune::FieldVector<ctype,dimworld> >& grid2_coords,
+                                const std::vector<unsigned int>& grid2_elements,
+                                const std::vector<Dune::GeometryType>& grid2_element_types,
+                                const std::vector<bool>& grid2_changed,
+                                const std::vector<std::pair<unsigned int, unsigned int> >& knownPairs)
+  {
+    DUNE_THROW(Dune::NotImplemented, "This merger does not support incremental builds");
+  }
+
   /** @brief get the number of simplices in the merged grid
       The indices are then in 0..nSimplices()-1
    */
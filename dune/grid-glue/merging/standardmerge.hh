@@ -133,9 +133,65 @@ protected:
                        const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
                        const std::vector<Dune::GeometryType>& grid2_element_types);
 
+  /** \brief Find an element of grid2 that intersects the given grid1 element
+   * \return the index of the grid2 element, or -1 if there is none
+   */
+  int bruteForceSearchGrid2(int candidate0,
+                            const std::vector<Dune::FieldVector<T,dimworld> >& grid1Coords,
+                            const std::vector<Dune::GeometryType>& grid1_element_types,
+                            const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
+                            const std::vector<Dune::GeometryType>& grid2_element_types);
+
   void computeNeighborsPerElement(const std::vector<Dune::GeometryType>& grid1_element_types,
                                   const std::vector<Dune::GeometryType>& grid2_element_types);
 
+  /** \brief Find a grid1 element intersecting candidate1 among the known partners of its neighbors
+   * \return the index of the grid1 element, or -1 if there is none
+   */
+  int findSeedFromNeighbors1(unsigned int candidate1,
+                             const std::vector<std::vector<unsigned int> >& partners2,
+                             const std::vector<Dune::FieldVector<T,dimworld> >& grid1Coords,
+                             const std::vector<Dune::GeometryType>& grid1_element_types,
+                             const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
+                             const std::vector<Dune::GeometryType>& grid2_element_types);
+
+  /** \brief Find a grid2 element intersecting candidate0 among the known partners of its neighbors
+   * \return the index of the grid2 element, or -1 if there is none
+   */
+  int findSeedFromNeighbors2(unsigned int candidate0,
+                             const std::vector<std::vector<unsigned int> >& partners1,
+                             const std::vector<Dune::FieldVector<T,dimworld> >& grid1Coords,
+                             const std::vector<Dune::GeometryType>& grid1_element_types,
+                             const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
+                             const std::vector<Dune::GeometryType>& grid2_element_types);
+
+  /** \brief Compute all intersections of the grid2 element candidate1, advancing over grid1 from seed */
+  void advanceFront1(unsigned int candidate1, unsigned int seed,
+                     std::vector<std::vector<unsigned int> >& partners1,
+                     std::vector<std::vector<unsigned int> >& partners2,
+                     const std::vector<Dune::FieldVector<T,dimworld> >& grid1Coords,
+                     const std::vector<Dune::GeometryType>& grid1_element_types,
+                     const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
+                     const std::vector<Dune::GeometryType>& grid2_element_types);
+
+  /** \brief Compute the intersections of the grid1 element candidate0 with unchanged grid2 elements,
+   *         advancing over grid2 from seed
+   */
+  void advanceFront2(unsigned int candidate0, unsigned int seed,
+                     const std::vector<bool>& grid2_changed,
+                     std::vector<std::vector<unsigned int> >& partners1,
+                     std::vector<std::vector<unsigned int> >& partners2,
+                     const std::vector<Dune::FieldVector<T,dimworld> >& grid1Coords,
+                     const std::vector<Dune::GeometryType>& grid1_element_types,
+                     const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
+                     const std::vector<Dune::GeometryType>& grid2_element_types);
+
+  /** \brief Copy the element corners into the block-structured arrays grid1ElementCorners_ and grid2ElementCorners_ */
+  void setupElementCorners(const std::vector<unsigned int>& grid1_elements,
+                           const std::vector<Dune::GeometryType>& grid1_element_types,
+                           const std::vector<unsigned int>& grid2_elements,
+                           const std::vector<Dune::GeometryType>& grid2_element_types);
+
   /*   M E M B E R   V A R I A B L E S   */
 
   /** \brief The computed intersections */
@@ -172,6 +228,34 @@ public:
              const std::vector<Dune::GeometryType>& grid2_element_types
              );
 
+  /** \brief StandardMerge supports incremental builds */
+  bool supportsIncrementalBuild() const
+  {
+    return true;
+  }
+
+  /**
+   * @brief compute only those intersections that are affected by a local change of the input grids
+   *
+   * For each changed element the advancing front algorithm is started from a seed that is
+   * taken from the intersection partners of its neighbors.  Only if no such seed exists
+   * a brute-force search is done.  Hence the number of intersection computations is
+   * roughly proportional to the size of the change.  The element corner and neighbor
+   * tables are still set up for both whole grids, so each call costs time linear in
+   * the size of the grids, too.
+   *
+   * \see Merger::buildIncremental
+   */
+  void buildIncremental(const std::vector<Dune::FieldVector<T,dimworld> >& grid1Coords,
+                        const std::vector<unsigned int>& grid1_elements,
+                        const std::vector<Dune::GeometryType>& grid1_element_types,
+                        const std::vector<bool>& grid1_changed,
+                        const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
+                        const std::vector<unsigned int>& grid2_elements,
+                        const std::vector<Dune::GeometryType>& grid2_element_types,
+                        const std::vector<bool>& grid2_changed,
+                        const std::vector<std::pair<unsigned int, unsigned int> >& knownPairs);
+
 
   /*   Q U E S T I O N I N G   T H E   M E R G E D   G R I D   */
 
@@ -350,6 +434,76 @@ int StandardMerge<T,grid1Dim,grid2Dim,dimworld>::bruteForceSearch(int candidate1
 }
 
 
+template<typename T, int grid1Dim, int grid2Dim, int dimworld>
+int StandardMerge<T,grid1Dim,grid2Dim,dimworld>::bruteForceSearchGrid2(int candidate0,
+                                                                       const std::vector<Dune::FieldVector<T,dimworld> >& grid1Coords,
+                                                                       const std::vector<Dune::GeometryType>& grid1_element_types,
+                                                                       const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
+                                                                       const std::vector<Dune::GeometryType>& grid2_element_types)
+{
+  for (std::size_t i=0; i<grid2_element_types.size(); i++) {
+
+    std::bitset<(1<<grid1Dim)> neighborIntersects1;
+    std::bitset<(1<<grid2Dim)> neighborIntersects2;
+    bool intersectionFound = testIntersection(candidate0, i,
+                                              grid1Coords,grid1_element_types, neighborIntersects1,
+                                              grid2Coords,grid2_element_types, neighborIntersects2);
+
+    // if there is an intersection, i is our new seed candidate on the grid2 side
+    if (intersectionFound)
+      return i;
+
+  }
+
+  return -1;
+}
+
+
+template<typename T, int grid1Dim, int grid2Dim, int dimworld>
+void StandardMerge<T,grid1Dim,grid2Dim,dimworld>::
+setupElementCorners(const std::vector<unsigned int>& grid1_elements,
+                    const std::vector<Dune::GeometryType>& grid1_element_types,
+                    const std::vector<unsigned int>& grid2_elements,
+                    const std::vector<Dune::GeometryType>& grid2_element_types)
+{
+  // /////////////////////////////////////////////////////////////////////
+  //   Copy element corners into a data structure with block-structure.
+  //   This is not as efficient but a lot easier to use.
+  //   We may think about efficiency later.
+  // /////////////////////////////////////////////////////////////////////
+
+  // first the grid1 side
+  grid1ElementCorners_.resize(grid1_element_types.size());
+
+  unsigned int grid1CornerCounter = 0;
+
+  for (std::size_t i=0; i<grid1_element_types.size(); i++) {
+
+    // Select vertices of the grid1 element
+    int numVertices = Dune::GenericReferenceElements<T,grid1Dim>::general(grid1_element_types[i]).size(grid1Dim);
+    grid1ElementCorners_[i].resize(numVertices);
+    for (int j=0; j<numVertices; j++)
+      grid1ElementCorners_[i][j] = grid1_elements[grid1CornerCounter++];
+
+  }
+
+  // then the grid2 side
+  grid2ElementCorners_.resize(grid2_element_types.size());
+
+  unsigned int grid2CornerCounter = 0;
+
+  for (std::size_t i=0; i<grid2_element_types.size(); i++) {
+
+    // Select vertices of the grid2 element
+    int numVertices = Dune::GenericReferenceElements<T,grid2Dim>::general(grid2_element_types[i]).size(grid2Dim);
+    grid2ElementCorners_[i].resize(numVertices);
+    for (int j=0; j<numVertices; j++)
+      grid2ElementCorners_[i][j] = grid2_elements[grid2CornerCounter++];
+
+  }
+}
+
+
 template<typename T, int grid1Dim, int grid2Dim, int dimworld>
 void StandardMerge<T,grid1Dim,grid2Dim,dimworld>::
 computeNeighborsPerElement(const std::vector<Dune::GeometryType>& grid1_element_types,
@@ -474,41 +628,8 @@ void StandardMerge<T,grid1Dim,grid2Dim,dimworld>::build(const std::vector<Dune::
   intersections_.clear();
   this->counter = 0;
 
-  // /////////////////////////////////////////////////////////////////////
-  //   Copy element corners into a data structure with block-structure.
-  //   This is not as efficient but a lot easier to use.
-  //   We may think about efficiency later.
-  // /////////////////////////////////////////////////////////////////////
-
-  // first the grid1 side
-  grid1ElementCorners_.resize(grid1_element_types.size());
-
-  unsigned int grid1CornerCounter = 0;
-
-  for (std::size_t i=0; i<grid1_element_types.size(); i++) {
-
-    // Select vertices of the grid1 element
-    int numVertices = Dune::GenericReferenceElements<T,grid1Dim>::general(grid1_element_types[i]).size(grid1Dim);
-    grid1ElementCorners_[i].resize(numVertices);
-    for (int j=0; j<numVertices; j++)
-      grid1ElementCorners_[i][j] = grid1_elements[grid1CornerCounter++];
-
-  }
-
-  // then the grid2 side
-  grid2ElementCorners_.resize(grid2_element_types.size());
-
-  unsigned int grid2CornerCounter = 0;
-
-  for (std::size_t i=0; i<grid2_element_types.size(); i++) {
-
-    // Select vertices of the grid2 element
-    int numVertices = Dune::GenericReferenceElements<T,grid2Dim>::general(grid2_element_types[i]).size(grid2Dim);
-    grid2ElementCorners_[i].resize(numVertices);
-    for (int j=0; j<numVertices; j++)
-      grid2ElementCorners_[i][j] = grid2_elements[grid2CornerCounter++];
-
-  }
+  setupElementCorners(grid1_elements, grid1_element_types,
+                      grid2_elements, grid2_element_types);
 
   ////////////////////////////////////////////////////////////////////////
   //  Compute the face neighbors for each element
@@ -715,6 +836,351 @@ void StandardMerge<T,grid1Dim,grid2Dim,dimworld>::build(const std::vector<Dune::
 }
 
 
+template<typename T, int grid1Dim, int grid2Dim, int dimworld>
+int StandardMerge<T,grid1Dim,grid2Dim,dimworld>::
+findSeedFromNeighbors1(unsigned int candidate1,
+                       const std::vector<std::vector<unsigned int> >& partners2,
+                       const std::vector<Dune::FieldVector<T,dimworld> >& grid1Coords,
+                       const std::vector<Dune::GeometryType>& grid1_element_types,
+                       const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
+                       const std::vector<Dune::GeometryType>& grid2_element_types)
+{
+  if (!partners2[candidate1].empty())
+    return partners2[candidate1][0];
+
+  std::set<int> isTested;
+
+  // Test the partners of the neighbors of candidate1, and the neighbors of those partners
+  for (std::size_t n=0; n<elementNeighbors2_[candidate1].size(); n++) {
+
+    int neighbor = elementNeighbors2_[candidate1][n];
+    if (neighbor == -1)
+      continue;
+
+    for (std::size_t p=0; p<partners2[neighbor].size(); p++) {
+
+      unsigned int partner = partners2[neighbor][p];
+
+      for (int m=-1; m<(int)elementNeighbors1_[partner].size(); m++) {
+
+        int candidate0 = (m<0) ? (int)partner : elementNeighbors1_[partner][m];
+        if (candidate0 == -1 || !isTested.insert(candidate0).second)
+          continue;
+
+        std::bitset<(1<<grid1Dim)> neighborIntersects1;
+        std::bitset<(1<<grid2Dim)> neighborIntersects2;
+        if (testIntersection(candidate0, candidate1,
+                             grid1Coords,grid1_element_types, neighborIntersects1,
+                             grid2Coords,grid2_element_types, neighborIntersects2))
+          return candidate0;
+
+      }
+
+    }
+
+  }
+
+  return -1;
+}
+
+
+template<typename T, int grid1Dim, int grid2Dim, int dimworld>
+int StandardMerge<T,grid1Dim,grid2Dim,dimworld>::
+findSeedFromNeighbors2(unsigned int candidate0,
+                       const std::vector<std::vector<unsigned int> >& partners1,
+                       const std::vector<Dune::FieldVector<T,dimworld> >& grid1Coords,
+                       const std::vector<Dune::GeometryType>& grid1_element_types,
+                       const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
+                       const std::vector<Dune::GeometryType>& grid2_element_types)
+{
+  if (!partners1[candidate0].empty())
+    return partners1[candidate0][0];
+
+  std::set<int> isTested;
+
+  // Test the partners of the neighbors of candidate0, and the neighbors of those partners
+  for (std::size_t n=0; n<elementNeighbors1_[candidate0].size(); n++) {
+
+    int neighbor = elementNeighbors1_[candidate0][n];
+    if (neighbor == -1)
+      continue;
+
+    for (std::size_t p=0; p<partners1[neighbor].size(); p++) {
+
+      unsigned int partner = partners1[neighbor][p];
+
+      for (int m=-1; m<(int)elementNeighbors2_[partner].size(); m++) {
+
+        int candidate1 = (m<0) ? (int)partner : elementNeighbors2_[partner][m];
+        if (candidate1 == -1 || !isTested.insert(candidate1).second)
+          continue;
+
+        std::bitset<(1<<grid1Dim)> neighborIntersects1;
+        std::bitset<(1<<grid2Dim)> neighborIntersects2;
+        if (testIntersection(candidate0, candidate1,
+                             grid1Coords,grid1_element_types, neighborIntersects1,
+                             grid2Coords,grid2_element_types, neighborIntersects2))
+          return candidate1;
+
+      }
+
+    }
+
+  }
+
+  return -1;
+}
+
+
+template<typename T, int grid1Dim, int grid2Dim, int dimworld>
+void StandardMerge<T,grid1Dim,grid2Dim,dimworld>::
+advanceFront1(unsigned int candidate1, unsigned int seed,
+              std::vector<std::vector<unsigned int> >& partners1,
+              std::vector<std::vector<unsigned int> >& partners2,
+              const std::vector<Dune::FieldVector<T,dimworld> >& grid1Coords,
+              const std::vector<Dune::GeometryType>& grid1_element_types,
+              const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
+              const std::vector<Dune::GeometryType>& grid2_element_types)
+{
+  std::stack<unsigned int> candidates0;
+  std::set<unsigned int> isCandidate0;
+
+  candidates0.push(seed);
+  isCandidate0.insert(seed);
+
+  while (!candidates0.empty()) {
+
+    unsigned int currentCandidate0 = candidates0.top();
+    candidates0.pop();
+
+    std::bitset<(1<<grid1Dim)> neighborIntersects1;
+    std::bitset<(1<<grid2Dim)> neighborIntersects2;
+    bool intersectionFound = computeIntersection(currentCandidate0, candidate1,
+                                                 grid1Coords,grid1_element_types, neighborIntersects1,
+                                                 grid2Coords,grid2_element_types, neighborIntersects2);
+
+    if (!intersectionFound)
+      continue;
+
+    partners1[currentCandidate0].push_back(candidate1);
+    partners2[candidate1].push_back(currentCandidate0);
+
+    // add neighbors of currentCandidate0 to the list of elements to be checked
+    for (std::size_t i=0; i<elementNeighbors1_[currentCandidate0].size(); i++) {
+
+      int neighbor = elementNeighbors1_[currentCandidate0][i];
+
+      if (neighbor != -1 && isCandidate0.insert(neighbor).second)
+        candidates0.push(neighbor);
+
+    }
+
+  }
+}
+
+
+template<typename T, int grid1Dim, int grid2Dim, int dimworld>
+void StandardMerge<T,grid1Dim,grid2Dim,dimworld>::
+advanceFront2(unsigned int candidate0, unsigned int seed,
+              const std::vector<bool>& grid2_changed,
+              std::vector<std::vector<unsigned int> >& partners1,
+              std::vector<std::vector<unsigned int> >& partners2,
+              const std::vector<Dune::FieldVector<T,dimworld> >& grid1Coords,
+              const std::vector<Dune::GeometryType>& grid1_element_types,
+              const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
+              const std::vector<Dune::GeometryType>& grid2_element_types)
+{
+  std::stack<unsigned int> candidates1;
+  std::set<unsigned int> isCandidate1;
+
+  candidates1.push(seed);
+  isCandidate1.insert(seed);
+
+  while (!candidates1.empty()) {
+
+    unsigned int currentCandidate1 = candidates1.top();
+    candidates1.pop();
+
+    bool intersectionFound;
+
+    if (grid2_changed[currentCandidate1]) {
+
+      // This pair has been computed in the first pass already
+      intersectionFound = std::find(partners2[currentCandidate1].begin(), partners2[currentCandidate1].end(), candidate0)
+                          != partners2[currentCandidate1].end();
+
+    } else {
+
+      std::bitset<(1<<grid1Dim)> neighborIntersects1;
+      std::bitset<(1<<grid2Dim)> neighborIntersects2;
+      intersectionFound = computeIntersection(candidate0, currentCandidate1,
+                                              grid1Coords,grid1_element_types, neighborIntersects1,
+                                              grid2Coords,grid2_element_types, neighborIntersects2);
+
+      if (intersectionFound) {
+        partners1[candidate0].push_back(currentCandidate1);
+        partners2[currentCandidate1].push_back(candidate0);
+      }
+
+    }
+
+    if (!intersectionFound)
+      continue;
+
+    // add neighbors of currentCandidate1 to the list of elements to be checked
+    for (std::size_t i=0; i<elementNeighbors2_[currentCandidate1].size(); i++) {
+
+      int neighbor = elementNeighbors2_[currentCandidate1][i];
+
+      if (neighbor != -1 && isCandidate1.insert(neighbor).second)
+        candidates1.push(neighbor);
+
+    }
+
+  }
+}
+
+
+// /////////////////////////////////////////////////////////////////////
+//   Recompute the intersections of changed elements only
+// /////////////////////////////////////////////////////////////////////
+
+template<typename T, int grid1Dim, int grid2Dim, int dimworld>
+void StandardMerge<T,grid1Dim,grid2Dim,dimworld>::buildIncremental(const std::vector<Dune::FieldVector<T,dimworld> >& grid1Coords,
+                                                                   const std::vector<unsigned int>& grid1_elements,
+                                                                   const std::vector<Dune::GeometryType>& grid1_element_types,
+                                                                   const std::vector<bool>& grid1_changed,
+                                                                   const std::vector<Dune::FieldVector<T,dimworld> >& grid2Coords,
+                                                                   const std::vector<unsigned int>& grid2_elements,
+                                                                   const std::vector<Dune::GeometryType>& grid2_element_types,
+                                                                   const std::vector<bool>& grid2_changed,
+                                                                   const std::vector<std::pair<unsigned int, unsigned int> >& knownPairs)
+{
+  assert(grid1_changed.size() == grid1_element_types.size());
+  assert(grid2_changed.size() == grid2_element_types.size());
+
+  clear();
+  this->counter = 0;
+
+  setupElementCorners(grid1_elements, grid1_element_types,
+                      grid2_elements, grid2_element_types);
+
+  computeNeighborsPerElement(grid1_element_types, grid2_element_types);
+
+  // The intersection partners of each element, as far as they are known
+  std::vector<std::vector<unsigned int> > partners1(grid1_element_types.size());
+  std::vector<std::vector<unsigned int> > partners2(grid2_element_types.size());
+
+  for (std::size_t i=0; i<knownPairs.size(); i++) {
+    partners1[knownPairs[i].first].push_back(knownPairs[i].second);
+    partners2[knownPairs[i].second].push_back(knownPairs[i].first);
+  }
+
+  // /////////////////////////////////////////////////////////////////////
+  //   First pass: intersect the changed grid2 elements with all of grid1.
+  //   Elements without a neighbor with known partners are deferred until
+  //   their neighbors have been treated.  Only if no progress can be made
+  //   that way we resort to a brute-force search.
+  // /////////////////////////////////////////////////////////////////////
+
+  std::vector<unsigned int> pending;
+  for (std::size_t j=0; j<grid2_changed.size(); j++)
+    if (grid2_changed[j])
+      pending.push_back(j);
+
+  while (!pending.empty()) {
+
+    std::vector<unsigned int> deferred;
+
+    for (std::size_t k=0; k<pending.size(); k++) {
+
+      int seed = findSeedFromNeighbors1(pending[k], partners2,
+                                        grid1Coords,grid1_element_types,
+                                        grid2Coords,grid2_element_types);
+
+      if (seed < 0)
+        deferred.push_back(pending[k]);
+      else
+        advanceFront1(pending[k], seed, partners1, partners2,
+                      grid1Coords,grid1_element_types,
+                      grid2Coords,grid2_element_types);
+
+    }
+
+    if (!deferred.empty() && deferred.size() == pending.size()) {
+
+      unsigned int candidate1 = deferred.back();
+      deferred.pop_back();
+
+      int seed = bruteForceSearch(candidate1,
+                                  grid1Coords,grid1_element_types,
+                                  grid2Coords,grid2_element_types);
+
+      // no seed means that candidate1 isn't overlapped by anything
+      if (seed >= 0)
+        advanceFront1(candidate1, seed, partners1, partners2,
+                      grid1Coords,grid1_element_types,
+                      grid2Coords,grid2_element_types);
+
+    }
+
+    pending.swap(deferred);
+
+  }
+
+  // /////////////////////////////////////////////////////////////////////
+  //   Second pass: intersect the changed grid1 elements with the
+  //   unchanged grid2 elements.  The pairs with changed grid2 elements
+  //   are known from the first pass.
+  // /////////////////////////////////////////////////////////////////////
+
+  for (std::size_t i=0; i<grid1_changed.size(); i++)
+    if (grid1_changed[i])
+      pending.push_back(i);
+
+  while (!pending.empty()) {
+
+    std::vector<unsigned int> deferred;
+
+    for (std::size_t k=0; k<pending.size(); k++) {
+
+      int seed = findSeedFromNeighbors2(pending[k], partners1,
+                                        grid1Coords,grid1_element_types,
+                                        grid2Coords,grid2_element_types);
+
+      if (seed < 0)
+        deferred.push_back(pending[k]);
+      else
+        advanceFront2(pending[k], seed, grid2_changed, partners1, partners2,
+                      grid1Coords,grid1_element_types,
+                      grid2Coords,grid2_element_types);
+
+    }
+
+    if (!deferred.empty() && deferred.size() == pending.size()) {
+
+      unsigned int candidate0 = deferred.back();
+      deferred.pop_back();
+
+      int seed = bruteForceSearchGrid2(candidate0,
+                                       grid1Coords,grid1_element_types,
+                                       grid2Coords,grid2_element_types);
+
+      if (seed >= 0)
+        advanceFront2(candidate0, seed, grid2_changed, partners1, partners2,
+                      grid1Coords,grid1_element_types,
+                      grid2Coords,grid2_element_types);
+
+    }
+
+    pending.swap(deferred);
+
+  }
+
+  valid = true;
+}
+
+
 template<typename T, int grid1Dim, int grid2Dim, int dimworld>
 inline unsigned int StandardMerge<T,grid1Dim,grid2Dim,dimworld>::nSimplices() const
 {
@@ -0,0 +1,91 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/mpihelper.hh>
+#include <dune/common/fvector.hh>
+#include <dune/grid/sgrid.hh>
+
+#include <dune/grid-glue/extractors/extractorpredicate.hh>
+#include <dune/grid-glue/extractors/codim0extractor.hh>
+#include <dune/grid-glue/extractors/codim1extractor.hh>
+
+#include <dune/grid-glue/test/patchtest.hh>
+
+using namespace Dune;
+
+/*
+   The extractors accept any callable as predicate, in the constructor, in
+   update() and in the incremental update().  Each of them has to give the
+   same patch as the equivalent virtual ExtractorPredicate.
+ */
+
+template <class GridView>
+void testCodim0(const GridView& gv)
+{
+  typedef Codim0Extractor<GridView> Extractor;
+
+  LeftOfDescriptor<GridView> descr(0.5);
+  const Extractor reference(gv, descr);
+  assert(reference.nSubEntities() > 0);
+
+  Extractor extractor(gv, LeftOf(0.5));
+  assert(identicalPatch(extractor, reference));
+
+  extractor.update(LeftOf(0.75));
+  extractor.update(LeftOf(0.5));
+  assert(identicalPatch(extractor, reference));
+
+  // the incremental update with a callable ends up with the same elements
+  descr.threshold_ = 0.75;
+  Extractor grown(gv, descr);
+  Extractor incremental(gv, LeftOf(0.5));
+  incremental.update(LeftOf(0.75), allElements(gv));
+  assert(samePatch(incremental, grown));
+}
+
+template <class GridView>
+void testCodim1(const GridView& gv)
+{
+  typedef Codim1Extractor<GridView> Extractor;
+
+  const Extractor reference(gv, RightFaceDescriptor<GridView>());
+  assert(reference.nSubEntities() > 0);
+
+  Extractor extractor(gv, RightFace());
+  assert(identicalPatch(extractor, reference));
+
+  extractor.update(RightFace());
+  assert(identicalPatch(extractor, reference));
+
+  extractor.update(RightFace(), allElements(gv));
+  assert(samePatch(extractor, reference));
+}
+
+template <int dim>
+void testGrid()
+{
+  typedef SGrid<dim,dim> GridType;
+
+  FieldVector<int,dim> elements(4);
+  FieldVector<double,dim> lower(0);
+  FieldVector<double,dim> upper(1);
+  GridType grid(elements, lower, upper);
+
+  testCodim0(grid.leafView());
+  testCodim1(grid.leafView());
+}
+
+int main(int argc, char** argv)
+{
+  MPIHelper::instance(argc, argv);
+
+  testGrid<2>();
+  testGrid<3>();
+
+  return 0;
+}
@@ -0,0 +1,184 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cassert>
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include <dune/common/mpihelper.hh>
+#include <dune/common/fvector.hh>
+#include <dune/grid/sgrid.hh>
+
+#include <dune/grid-glue/extractors/extractorpredicate.hh>
+#include <dune/grid-glue/extractors/codim1extractor.hh>
+
+#include <dune/grid-glue/test/patchtest.hh>
+
+using namespace Dune;
+
+/*
+   The boundary faces of a cube grid are extracted with a BoundaryIdPredicate
+   and with the boundary traversal, which only visits the elements at the
+   boundary once they are known.  Both have to give the same surface as the
+   extraction through a virtual predicate of a fresh extractor, also after the
+   grid has been refined.
+ */
+
+/** \brief Selects all boundary faces */
+template <class GridView>
+class AllFacesDescriptor
+  : public ExtractorPredicate<GridView,1>
+{
+public:
+  virtual bool contains(const typename GridView::Traits::template Codim<0>::EntityPointer& element, unsigned int face) const
+  {
+    return true;
+  }
+};
+
+template <class GridView>
+void testBoundaryIds(const GridView& gv)
+{
+  typedef Codim1Extractor<GridView> Extractor;
+  typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+  typedef typename GridView::IntersectionIterator IntersectionIterator;
+
+  // the boundary ids of the grid, select the faces with the smallest one
+  std::set<int> allIds;
+  for (ElementIterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+    for (IntersectionIterator iit = gv.ibegin(*it); iit != gv.iend(*it); ++iit)
+      if (iit->boundary())
+        allIds.insert(iit->boundaryId());
+  assert(!allIds.empty());
+  const BoundaryIdPredicate selected(*allIds.begin());
+
+  unsigned int expected = 0;
+  unsigned int boundaryFaces = 0;
+  for (ElementIterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+    for (IntersectionIterator iit = gv.ibegin(*it); iit != gv.iend(*it); ++iit)
+      if (iit->boundary())
+      {
+        ++boundaryFaces;
+        if (selected(*iit))
+          ++expected;
+      }
+  assert(expected > 0);
+  assert(allIds.size() == 1 || expected < boundaryFaces);
+
+  Extractor extractor(gv, selected);
+  std::vector<typename Extractor::VertexVector> faces;
+  extractor.getFaces(faces);
+  std::cout << "BoundaryIdPredicate selects " << faces.size() << " of "
+            << boundaryFaces << " boundary faces" << std::endl;
+  assert(faces.size() == expected);
+
+  // every extracted face has the selected id
+  for (unsigned int i = 0; i < faces.size(); ++i)
+  {
+    const int face = extractor.indexInInside(i);
+    const typename Extractor::ElementPtr element = extractor.element(i);
+    for (IntersectionIterator iit = gv.ibegin(*element); iit != gv.iend(*element); ++iit)
+      if (iit->indexInInside() == face)
+        assert(iit->boundary() && selected(*iit));
+  }
+
+  // the same faces on several threads, with the boundary traversal and incrementally
+  Extractor parallel(gv, selected);
+  parallel.parallelExtraction() = true;
+  parallel.update(selected);
+  assert(identicalPatch(parallel, extractor));
+
+  parallel.boundaryTraversal() = true;
+  parallel.update(selected);
+  parallel.update(selected);
+  assert(identicalPatch(parallel, extractor));
+
+  Extractor incremental(gv, AllFacesDescriptor<GridView>());
+  incremental.update(selected, allElements(gv));
+  std::vector<typename Extractor::VertexVector> incrementalFaces;
+  incremental.getFaces(incrementalFaces);
+  assert(incrementalFaces.size() == expected);
+}
+
+template <class Grid>
+void testBoundaryTraversal(Grid& grid, bool parallel)
+{
+  typedef typename Grid::LeafGridView GridView;
+  typedef Codim1Extractor<GridView> Extractor;
+
+  AllFacesDescriptor<GridView> descr;
+  Extractor extractor(grid.leafView(), descr);
+  extractor.parallelExtraction() = parallel;
+  extractor.boundaryTraversal() = true;
+
+  // the first update collects the boundary elements, the second one only visits them
+  extractor.update(descr);
+  extractor.update(descr);
+  {
+    Extractor reference(grid.leafView(), descr);
+    assert(identicalPatch(extractor, reference));
+  }
+
+  // the number of elements changes, the boundary elements are collected again
+  grid.globalRefine(1);
+  extractor.update(descr);
+  {
+    Extractor reference(grid.leafView(), descr);
+    assert(identicalPatch(extractor, reference));
+  }
+  extractor.update(descr);
+  {
+    Extractor reference(grid.leafView(), descr);
+    assert(identicalPatch(extractor, reference));
+  }
+
+  // an announced modification discards them as well
+  extractor.gridChanged();
+  extractor.update(descr);
+  {
+    Extractor reference(grid.leafView(), descr);
+    assert(identicalPatch(extractor, reference));
+  }
+
+  // and so does resetting them explicitly
+  extractor.resetBoundaryElements();
+  extractor.update(descr);
+  {
+    Extractor reference(grid.leafView(), descr);
+    assert(identicalPatch(extractor, reference));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  MPIHelper::instance(argc, argv);
+
+  typedef SGrid<2,2> GridType;
+  FieldVector<int,2> elements(4);
+  FieldVector<double,2> lower(0);
+  FieldVector<double,2> upper(1);
+
+  {
+    GridType grid(elements, lower, upper);
+    testBoundaryIds(grid.leafView());
+  }
+
+  for (int parallel = 0; parallel < 2; ++parallel)
+  {
+    GridType grid(elements, lower, upper);
+    testBoundaryTraversal(grid, parallel);
+  }
+
+  typedef SGrid<3,3> GridType3d;
+  FieldVector<int,3> elements3d(2);
+  FieldVector<double,3> lower3d(0);
+  FieldVector<double,3> upper3d(1);
+  {
+    GridType3d grid(elements3d, lower3d, upper3d);
+    testBoundaryTraversal(grid, false);
+  }
+
+  return 0;
+}
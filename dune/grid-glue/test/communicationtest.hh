@@ -3,6 +3,8 @@
 #ifndef GRIDGLUE_COMMTEST_HH
 #define GRIDGLUE_COMMTEST_HH
 
+#include <cmath>
+
 template <typename ctype, int dimw, bool forward>
 class CheckGlobalCoordDataHandle :
   public Dune::GridGlue::CommDataHandle< CheckGlobalCoordDataHandle<ctype, dimw, forward>, Dune::FieldVector<ctype,dimw> >
@@ -63,6 +65,114 @@ public:
   }
 };
 
+/** \brief the same check as CheckGlobalCoordDataHandle, with the block interface */
+template <typename ctype, int dimw, bool forward>
+class CheckGlobalCoordBlockDataHandle :
+  public Dune::GridGlue::BlockCommDataHandle< CheckGlobalCoordBlockDataHandle<ctype, dimw, forward>, Dune::FieldVector<ctype,dimw> >
+{
+public:
+  /** \brief the number of corners only depends on the intersection */
+  bool fixedSize () const
+  {
+    return true;
+  }
+
+  template<class RISType>
+  size_t size (RISType& i) const
+  {
+    if (forward)
+      return i.geometry().corners();
+    else
+      return i.geometryOutside().corners();
+  }
+
+  template<class EntityType, class RISType>
+  void gather (const EntityType& e, const RISType & i, Dune::FieldVector<ctype,dimw>* values) const
+  {
+    assert(forward ? i.self() : i.neighbor());
+    for (size_t n=0; n<size(i); n++)
+      values[n] = forward ? i.geometry().corner(n) : i.geometryOutside().corner(n);
+  }
+
+  template<class EntityType, class RISType>
+  void scatter (const EntityType& e, const RISType & i, const Dune::FieldVector<ctype,dimw>* values, size_t n)
+  {
+    assert(forward ? i.neighbor() : i.self());
+    assert(n == size(i));
+    for (size_t k=0; k<n; k++)
+    {
+      if (forward)
+        assert( (values[k] - i.geometry().corner(k)).two_norm() < 1e-6 );
+      else
+        assert( (values[k] - i.geometryOutside().corner(k)).two_norm() < 1e-6 );
+    }
+  }
+};
+
+/** \brief sends the ownership of each intersection from the domain to the target side */
+template <class GlueType>
+class OwnershipDataHandle :
+  public Dune::GridGlue::BlockCommDataHandle< OwnershipDataHandle<GlueType>, int >
+{
+public:
+  OwnershipDataHandle (const GlueType& glue)
+    : glue_(glue), received(glue.size(), -1)
+  {}
+
+  bool fixedSize () const
+  {
+    return true;
+  }
+
+  template<class RISType>
+  size_t size (RISType& i) const
+  {
+    return 1;
+  }
+
+  template<class EntityType, class RISType>
+  void gather (const EntityType& e, const RISType & i, int* values) const
+  {
+    values[0] = glue_.isOwner(i.index());
+  }
+
+  template<class EntityType, class RISType>
+  void scatter (const EntityType& e, const RISType & i, const int* values, size_t n)
+  {
+    assert(n == 1);
+    received[i.index()] = values[0];
+  }
+
+  const GlueType& glue_;
+
+  /// @brief the ownership on the domain side, -1 if nothing was received
+  std::vector<int> received;
+};
+
+/** \brief check that every intersection has exactly one owner */
+template <class GlueType>
+void testOwnership (const GlueType& glue)
+{
+  OwnershipDataHandle<GlueType> dh(glue);
+  glue.communicate(dh, Dune::All_All_Interface, Dune::ForwardCommunication);
+
+  for (unsigned int i = 0; i < glue.size(); i++)
+  {
+    const typename GlueType::Intersection intersection = glue.getIntersection(i);
+
+    // both entities are on this rank, nobody else has the intersection
+    if (intersection.self() && intersection.neighbor())
+      assert(glue.isOwner(i));
+
+    // the domain side has told us whether it owns the intersection
+    else if (intersection.neighbor())
+    {
+      assert(dh.received[i] == 0 || dh.received[i] == 1);
+      assert(dh.received[i] + int(glue.isOwner(i)) == 1);
+    }
+  }
+}
+
 template <class GlueType>
 void testCommunication (const GlueType& glue)
 {
@@ -72,6 +182,53 @@ void testCommunication (const GlueType& glue)
   CheckGlobalCoordDataHandle<ctype, dimw, false> dh_backward;
   glue.communicate(dh_forward, Dune::All_All_Interface, Dune::ForwardCommunication);
   glue.communicate(dh_backward, Dune::All_All_Interface, Dune::BackwardCommunication);
+
+  // the second round reuses the sizes of the first one
+  CheckGlobalCoordBlockDataHandle<ctype, dimw, true> bdh_forward;
+  CheckGlobalCoordBlockDataHandle<ctype, dimw, false> bdh_backward;
+  for (int round = 0; round < 2; round++)
+  {
+    glue.communicate(bdh_forward, Dune::All_All_Interface, Dune::ForwardCommunication);
+    glue.communicate(bdh_backward, Dune::All_All_Interface, Dune::BackwardCommunication);
+  }
+}
+
+/** \brief a weight that differs between the intersections */
+struct CenterWeight
+{
+  template<class Intersection>
+  double operator() (const Intersection& intersection) const
+  {
+    return 1.0 + intersection.geometry().center().two_norm2();
+  }
+};
+
+/** \brief check that rebalanceOwnership() reports the imbalance of the weight each rank owns */
+template <class GlueType>
+void testRebalancing (GlueType& glue)
+{
+  const CenterWeight weight;
+  const double imbalance = glue.rebalanceOwnership(weight);
+  testOwnership(glue);
+
+  // the weight is evaluated on the side that has the geometry
+  double owned = 0;
+  for (unsigned int i = 0; i < glue.size(); i++)
+  {
+    if (!glue.isOwner(i))
+      continue;
+    if (glue.getIntersection(i).self())
+      owned += weight(glue.template getIntersection<0>(i));
+    else
+      owned += weight(glue.template getIntersection<1>(i));
+  }
+
+  const Dune::CollectiveCommunication<Dune::MPIHelper::MPICommunicator> cc
+    = Dune::MPIHelper::getCollectiveCommunication();
+  const double maxOwned = cc.max(owned);
+  const double total = cc.sum(owned);
+  if (total > 0)
+    assert(std::abs(imbalance - maxOwned * cc.size() / total) < 1e-8 * imbalance);
 }
 
 #endif // GRIDGLUE_COMMTEST_HH
@@ -0,0 +1,109 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/grid-glue/merging/conformingmerge.hh>
+
+using namespace Dune;
+
+/*
+   ConformingMerge is given a single cube element twice, the second time with
+   its corners numbered in a rotated order.  The two local positions of each
+   corner of each remote intersection have to map to the same world position,
+   and the simplices the cube is split into have to fill it.
+ */
+
+/** \brief the world position of the local position x in a cube with corners in Dune order */
+template <int dim>
+FieldVector<double,dim> cubeGlobal(const std::vector<FieldVector<double,dim> >& corners,
+                                   const FieldVector<double,dim>& x)
+{
+  FieldVector<double,dim> y(0);
+  for (unsigned int i = 0; i < corners.size(); ++i)
+  {
+    double weight = 1;
+    for (int k = 0; k < dim; ++k)
+      weight *= (i & (1u << k)) ? x[k] : 1 - x[k];
+    y.axpy(weight, corners[i]);
+  }
+  return y;
+}
+
+/** \brief the volume of a simplex */
+template <int dim>
+double simplexVolume(const std::vector<FieldVector<double,dim> >& corners)
+{
+  FieldMatrix<double,dim,dim> m;
+  for (int i = 0; i < dim; ++i)
+    m[i] = corners[i+1] - corners[0];
+  double factorial = 1;
+  for (int i = 2; i <= dim; ++i)
+    factorial *= i;
+  return std::abs(m.determinant()) / factorial;
+}
+
+template <int dim>
+void testRotatedCube()
+{
+  typedef ConformingMerge<dim,dim,double> MergeType;
+  typedef FieldVector<double,dim> Coords;
+
+  // the unit cube, and the same cube rotated by 90 degrees in the x-y plane
+  std::vector<Coords> grid1Coords(1 << dim), grid2Coords(1 << dim);
+  for (unsigned int i = 0; i < grid1Coords.size(); ++i)
+    for (int k = 0; k < dim; ++k)
+    {
+      grid1Coords[i][k] = (i & (1u << k)) ? 1 : 0;
+      grid2Coords[i][k] = grid1Coords[i][k];
+    }
+  for (unsigned int i = 0; i < grid2Coords.size(); ++i)
+  {
+    grid2Coords[i][0] = 1 - grid1Coords[i][1];
+    grid2Coords[i][1] = grid1Coords[i][0];
+  }
+
+  std::vector<unsigned int> elements;
+  for (unsigned int i = 0; i < grid1Coords.size(); ++i)
+    elements.push_back(i);
+  std::vector<GeometryType> types(1, GeometryType(GeometryType::cube, dim));
+
+  MergeType merger;
+  Merger<double,dim,dim,dim>& merge = merger;
+  merge.build(grid1Coords, elements, types, grid2Coords, elements, types);
+
+  std::cout << "ConformingMerge splits the " << dim << "d cube into "
+            << merge.nSimplices() << " simplices" << std::endl;
+  assert(merge.nSimplices() == ((dim == 2) ? 2u : 5u));
+
+  double volume = 0;
+  for (unsigned int k = 0; k < merge.nSimplices(); ++k)
+  {
+    std::vector<Coords> corners;
+    for (int c = 0; c < dim+1; ++c)
+    {
+      const Coords x1 = cubeGlobal(grid1Coords, merge.grid1ParentLocal(k, c));
+      const Coords x2 = cubeGlobal(grid2Coords, merge.grid2ParentLocal(k, c));
+      assert((x1 - x2).two_norm() < 1e-12);
+      corners.push_back(x1);
+    }
+    volume += simplexVolume(corners);
+  }
+  assert(std::abs(volume - 1.0) < 1e-12);
+}
+
+int main(int argc, char** argv)
+{
+  testRotatedCube<2>();
+  testRotatedCube<3>();
+
+  return 0;
+}
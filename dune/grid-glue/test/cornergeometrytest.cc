@@ -0,0 +1,61 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+
+#include <dune/grid-glue/common/cornergeometry.hh>
+
+/*
+   We map a few points with CornerGeometry on a triangle and a
+   quadrilateral in 3d and compare them with the expected images.
+ */
+
+typedef Dune::FieldVector<double,2> LocalCoordinate;
+typedef Dune::FieldVector<double,3> GlobalCoordinate;
+
+bool check(const GlobalCoordinate& x, const GlobalCoordinate& expected, const char* what)
+{
+  GlobalCoordinate diff = x;
+  diff -= expected;
+  if (diff.two_norm() > 1e-12) {
+    std::cerr << what << ": got " << x << ", expected " << expected << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main ()
+{
+  bool passed = true;
+
+  GlobalCoordinate corners[4];
+  corners[0][0] = 1; corners[0][1] = 0; corners[0][2] = 0;
+  corners[1][0] = 3; corners[1][1] = 0; corners[1][2] = 1;
+  corners[2][0] = 1; corners[2][1] = 2; corners[2][2] = 0;
+  corners[3][0] = 3; corners[3][1] = 4; corners[3][2] = 1;
+
+  LocalCoordinate x;
+  x[0] = 0.25; x[1] = 0.5;
+
+  // triangle 0 1 2: affine
+  typedef Dune::GridGlue::CornerGeometry<double,2,3> Geometry;
+  Geometry triangle(Dune::GeometryType(Dune::GeometryType::simplex, 2), corners);
+  GlobalCoordinate expected;
+  expected[0] = 1.5; expected[1] = 1; expected[2] = 0.25;
+  passed &= check(triangle.global(x), expected, "triangle");
+  passed &= (triangle.corners() == 3 && triangle.affine());
+
+  // quadrilateral 0 1 2 3: bilinear
+  Geometry quadrilateral(Dune::GeometryType(Dune::GeometryType::cube, 2), corners);
+  expected[0] = 1.5; expected[1] = 1.25; expected[2] = 0.25;
+  passed &= check(quadrilateral.global(x), expected, "quadrilateral");
+  for (int i = 0; i < 4; ++i) {
+    LocalCoordinate c;
+    c[0] = i & 1; c[1] = (i >> 1) & 1;
+    passed &= check(quadrilateral.global(c), corners[i], "quadrilateral corner");
+  }
+
+  return passed ? 0 : 1;
+}
@@ -3,14 +3,24 @@
 #ifndef GRIDGLUE_COUPLINGTEST_HH
 #define GRIDGLUE_COUPLINGTEST_HH
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <dune/common/exceptions.hh>
 #include <dune/common/fvector.hh>
 #include <dune/geometry/quadraturerules.hh>
 #include <dune/grid/common/mcmgmapper.hh>
 
 #include <dune/grid-glue/extractors/extractorpredicate.hh>
 #include <dune/grid-glue/adapter/gridglue.hh>
+#include <dune/grid-glue/adapter/couplingmatrixassembler.hh>
+#include <dune/grid-glue/common/parallelfor.hh>
 
 template <class IntersectionIt>
 void testIntersection(const IntersectionIt & rIIt)
@@ -71,6 +81,160 @@ void testIntersection(const IntersectionIt & rIIt)
 }
 
 
+/** \brief Compare the batched quadrature points with the ones computed by the intersections */
+template <int I, class GlueType>
+void testQuadraturePoints(const GlueType& glue)
+{
+  typedef typename GridGlueView<typename GlueType::Grid0Patch, typename GlueType::Grid1Patch, I>::IntersectionIterator IntersectionIterator;
+  typedef Dune::GridGlue::QuadraturePoints<typename GlueType::Grid0Patch, typename GlueType::Grid1Patch, I> QuadraturePoints;
+  const int dim = QuadraturePoints::mydim;
+
+  IntersectionIterator rIIt    = glue.template ibegin<I>();
+  IntersectionIterator rIEndIt = glue.template iend<I>();
+  if (rIIt == rIEndIt)
+    return;
+
+  const Dune::QuadratureRule<double, dim>& quad = Dune::QuadratureRules<double, dim>::rule(rIIt->type(), 3);
+  QuadraturePoints points;
+  glue.template quadraturePoints<I>(quad, points);
+
+  std::size_t b = 0;
+  for (; rIIt!=rIEndIt; ++rIIt)
+  {
+    if (!rIIt->self() || !rIIt->neighbor())
+      continue;
+
+    assert(b < points.size());
+    assert( std::abs(points.integrationElements[b] - rIIt->geometry().integrationElement(quad[0].position())) < 1e-8 );
+
+    for (unsigned int l=0; l<quad.size(); l++) {
+      const std::size_t k = points.index(b, l);
+      assert( (points.global[k] - rIIt->geometry().global(quad[l].position())).two_norm() < 1e-8 );
+      assert( (points.inside[k] - rIIt->geometryInInside().global(quad[l].position())).two_norm() < 1e-8 );
+      assert( (points.outside[k] - rIIt->geometryInOutside().global(quad[l].position())).two_norm() < 1e-8 );
+    }
+
+    ++b;
+  }
+  assert(b == points.size());
+}
+
+
+/** \brief Stores the volume of each intersection at its index */
+struct StoreVolume
+{
+  StoreVolume(std::vector<double>& volumes) : volumes_(volumes) {}
+
+  template <class Intersection>
+  void operator() (const Intersection& intersection, std::size_t index) const
+  {
+    volumes_[index] = intersection.geometry().volume();
+  }
+
+  std::vector<double>& volumes_;
+};
+
+/** \brief Throws on the last intersection */
+struct ThrowOnLast
+{
+  ThrowOnLast(std::size_t size) : size_(size) {}
+
+  template <class Intersection>
+  void operator() (const Intersection& intersection, std::size_t index) const
+  {
+    if (index + 1 == size_)
+      DUNE_THROW(Dune::RangeError, "intersection " << index);
+  }
+
+  std::size_t size_;
+};
+
+/** \brief Visit the intersections with parallel_for_intersections and compare with a serial loop */
+template <int I, class GlueType>
+void testParallelForIntersections(const GlueType& glue)
+{
+  // a small chunk size, to have several chunks even on small grids
+  std::vector<double> volumes(glue.size(), -1.0);
+  Dune::GridGlue::parallel_for_intersections<I>(glue, StoreVolume(volumes), 3);
+
+  for (unsigned int i=0; i<glue.size(); i++)
+    assert( std::abs(volumes[i] - glue.template getIntersection<I>(i).geometry().volume()) < 1e-12 );
+
+  // an exception on one of the threads reaches the caller
+  if (glue.size() == 0)
+    return;
+  bool thrown = false;
+  try
+  {
+    Dune::GridGlue::parallel_for_intersections<I>(glue, ThrowOnLast(glue.size()), 3);
+  }
+  catch (Dune::Exception&)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+
+/** \brief Piecewise constant basis, to test the coupling matrix assembly */
+template <class GridView>
+class P0Basis
+{
+  typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView, Dune::MCMGElementLayout> Mapper;
+  Mapper mapper_;
+
+public:
+  P0Basis(const GridView& gridView) : mapper_(gridView) {}
+
+  std::size_t size() const { return mapper_.size(); }
+
+  template <class Element>
+  unsigned int size(const Element& element) const { return 1; }
+
+  template <class Element>
+  std::size_t index(const Element& element, unsigned int i) const { return mapper_.map(element); }
+
+  template <class Element, class LocalCoordinate>
+  void evaluate(const Element& element, const LocalCoordinate& x, std::vector<double>& values) const
+  {
+    values.assign(1, 1.0);
+  }
+};
+
+/** \brief With piecewise constant bases, the entries of the coupling matrix add up to the size of the coupling interface */
+template <class GlueType>
+void testCouplingMatrix(const GlueType& glue)
+{
+  typedef typename GlueType::Grid0IntersectionIterator IntersectionIterator;
+  typedef Dune::GridGlue::CouplingMatrixAssembler<GlueType,0> Assembler;
+  const int dim = Assembler::Points::mydim;
+
+  IntersectionIterator rIIt    = glue.template ibegin<0>();
+  IntersectionIterator rIEndIt = glue.template iend<0>();
+  if (rIIt == rIEndIt)
+    return;
+
+  double area = 0;
+  for (IntersectionIterator it = rIIt; it!=rIEndIt; ++it)
+    if (it->self() && it->neighbor())
+      area += it->geometry().volume();
+
+  P0Basis<typename GlueType::Grid0View> basis0(glue.template gridView<0>());
+  P0Basis<typename GlueType::Grid1View> basis1(glue.template gridView<1>());
+
+  Assembler assembler(glue);
+  typename Assembler::Matrix matrix;
+  assembler.setupPattern(basis0, basis1, matrix);
+  assembler.assemble(basis0, basis1, Dune::QuadratureRules<double, dim>::rule(rIIt->type(), 1), matrix);
+
+  double sum = 0;
+  for (std::size_t i=0; i<matrix.nnz(); i++)
+    sum += matrix.values[i];
+
+  assert( std::abs(sum - area) < 1e-8 );
+}
+
+
 template <class GlueType>
 void testCoupling(const GlueType& glue)
 {
@@ -121,6 +285,54 @@ void testCoupling(const GlueType& glue)
       }
     }
   }
+
+#ifdef _OPENMP
+  // the batched evaluations have to run on more than one thread
+  if (omp_get_max_threads() < 2)
+    omp_set_num_threads(2);
+#endif
+
+  testQuadraturePoints<0>(glue);
+  testQuadraturePoints<1>(glue);
+  testParallelForIntersections<0>(glue);
+  testParallelForIntersections<1>(glue);
+  testCouplingMatrix(glue);
+}
+
+/** \brief Rebuild the glue with the different intersection orderings and test again */
+template <class GlueType>
+void testIntersectionOrderings(GlueType& glue)
+{
+  const std::size_t size = glue.size();
+
+  // the orderings only permute the intersections, so their volumes stay the same
+  std::vector<double> volumes;
+  for (unsigned int i=0; i<size; i++)
+    if (glue.template getIntersection<0>(i).self())
+      volumes.push_back(glue.template getIntersection<0>(i).geometry().volume());
+  std::sort(volumes.begin(), volumes.end());
+
+  const typename GlueType::IntersectionOrdering orderings[] = {
+    GlueType::Grid0ParentOrdering, GlueType::MortonOrdering, GlueType::MergerOrdering
+  };
+
+  for (int o=0; o<3; o++)
+  {
+    glue.setIntersectionOrdering(orderings[o]);
+    glue.build();
+    assert(glue.size() == size);
+
+    std::vector<double> sortedVolumes;
+    for (unsigned int i=0; i<size; i++)
+      if (glue.template getIntersection<0>(i).self())
+        sortedVolumes.push_back(glue.template getIntersection<0>(i).geometry().volume());
+    std::sort(sortedVolumes.begin(), sortedVolumes.end());
+    assert(sortedVolumes.size() == volumes.size());
+    for (std::size_t i=0; i<volumes.size(); i++)
+      assert( std::abs(sortedVolumes[i] - volumes[i]) < 1e-12 );
+
+    testCoupling(glue);
+  }
 }
 
 #endif // GRIDGLUE_COUPLINGTEST_HH
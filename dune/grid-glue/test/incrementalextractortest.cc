@@ -0,0 +1,198 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/mpihelper.hh>
+#include <dune/common/fvector.hh>
+#include <dune/geometry/genericreferenceelements.hh>
+#include <dune/grid/sgrid.hh>
+
+#include <dune/grid-glue/extractors/extractorpredicate.hh>
+#include <dune/grid-glue/extractors/codim0extractor.hh>
+#include <dune/grid-glue/extractors/codim1extractor.hh>
+
+#include <dune/grid-glue/test/patchtest.hh>
+
+using namespace Dune;
+
+/*
+   The extractors are updated incrementally, for the elements whose selection
+   has changed only.  The patch has to consist of the same subentities as the
+   one of a complete update, although they are numbered differently.  Once the
+   grid has been modified, the incremental update has to refuse to work until
+   the next complete update.
+ */
+
+/** \brief Selects the boundary faces whose center lies above a threshold */
+template <class GridView>
+class UpperFacesDescriptor
+  : public ExtractorPredicate<GridView,1>
+{
+public:
+  UpperFacesDescriptor(double threshold) : threshold_(threshold) {}
+
+  virtual bool contains(const typename GridView::Traits::template Codim<0>::EntityPointer& element, unsigned int face) const
+  {
+    const int dim = GridView::dimension;
+    const GenericReferenceElement<double,dim>& refElement = GenericReferenceElements<double,dim>::general(element->type());
+    return element->geometry().global(refElement.position(face,1))[dim-1] > threshold_;
+  }
+
+  double threshold_;
+};
+
+/** \brief the seeds of the elements whose center lies between two values of a coordinate */
+template <class GridView>
+std::vector<typename GridView::Grid::template Codim<0>::EntitySeed>
+elementsBetween(const GridView& gv, int direction, double lower, double upper)
+{
+  std::vector<typename GridView::Grid::template Codim<0>::EntitySeed> seeds;
+  typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+  for (ElementIterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+  {
+    const double x = it->geometry().center()[direction];
+    if (lower < x && x < upper)
+      seeds.push_back(it->seed());
+  }
+  return seeds;
+}
+
+/** \brief whether the incremental update throws because the grid has changed */
+template <class Extractor, class Descriptor>
+bool refusesIncrementalUpdate(Extractor& extractor, const Descriptor& descr)
+{
+  try
+  {
+    extractor.update(descr, elementsBetween(extractor.gridView(), 0, 0.0, 1.0));
+  }
+  catch (InvalidStateException&)
+  {
+    return true;
+  }
+  return false;
+}
+
+template <class Grid>
+void testCodim0(Grid& grid)
+{
+  typedef typename Grid::LeafGridView GridView;
+  typedef Codim0Extractor<GridView> Extractor;
+  const GridView gv = grid.leafView();
+
+  LeftOfDescriptor<GridView> descr(0.5);
+  Extractor extractor(gv, descr);
+
+  // grow the patch by the elements between the thresholds...
+  descr.threshold_ = 0.75;
+  extractor.update(descr, elementsBetween(gv, 0, 0.5, 0.75));
+  {
+    const Extractor reference(gv, descr);
+    assert(samePatch(extractor, reference));
+  }
+
+  // ...and shrink it beyond the initial patch
+  descr.threshold_ = 0.25;
+  extractor.update(descr, elementsBetween(gv, 0, 0.25, 0.75));
+  {
+    const Extractor reference(gv, descr);
+    assert(samePatch(extractor, reference));
+  }
+
+  // an announced modification of the grid requires a complete update...
+  extractor.gridChanged();
+  assert(refusesIncrementalUpdate(extractor, descr));
+  extractor.update(descr);
+  assert(!refusesIncrementalUpdate(extractor, descr));
+
+  // ...and so does a refinement
+  grid.globalRefine(1);
+  assert(refusesIncrementalUpdate(extractor, descr));
+  extractor.update(descr);
+  descr.threshold_ = 0.5;
+  extractor.update(descr, elementsBetween(gv, 0, 0.25, 0.5));
+  {
+    const Extractor reference(gv, descr);
+    assert(samePatch(extractor, reference));
+  }
+}
+
+template <class Grid>
+void testCodim1(Grid& grid)
+{
+  const int dim = Grid::dimension;
+  typedef typename Grid::LeafGridView GridView;
+  typedef Codim1Extractor<GridView> Extractor;
+  const GridView gv = grid.leafView();
+
+  // the boundary traversal collects the elements at the boundary
+  UpperFacesDescriptor<GridView> descr(0.9);
+  Extractor extractor(gv, descr);
+  extractor.boundaryTraversal() = true;
+  extractor.update(descr);
+
+  // add the faces further down the boundary of the elements between the thresholds
+  descr.threshold_ = 0.4;
+  extractor.update(descr, elementsBetween(gv, dim-1, 0.4, 0.9));
+  {
+    const Extractor reference(gv, descr);
+    assert(samePatch(extractor, reference));
+  }
+
+  // the complete update through the boundary elements still finds all faces
+  extractor.update(descr);
+  {
+    const Extractor reference(gv, descr);
+    assert(samePatch(extractor, reference));
+  }
+
+  // remove them again
+  descr.threshold_ = 0.6;
+  extractor.update(descr, elementsBetween(gv, dim-1, 0.0, 1.0));
+  {
+    const Extractor reference(gv, descr);
+    assert(samePatch(extractor, reference));
+  }
+
+  grid.globalRefine(1);
+  assert(refusesIncrementalUpdate(extractor, descr));
+  extractor.update(descr);
+  {
+    const Extractor reference(gv, descr);
+    assert(samePatch(extractor, reference));
+  }
+}
+
+template <int dim>
+void testGrid()
+{
+  typedef SGrid<dim,dim> GridType;
+
+  FieldVector<int,dim> elements(8);
+  FieldVector<double,dim> lower(0);
+  FieldVector<double,dim> upper(1);
+
+  std::cout << "testing the incremental update on a " << dim << "d grid" << std::endl;
+  {
+    GridType grid(elements, lower, upper);
+    testCodim0(grid);
+  }
+  {
+    GridType grid(elements, lower, upper);
+    testCodim1(grid);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  MPIHelper::instance(argc, argv);
+
+  testGrid<2>();
+  testGrid<3>();
+
+  return 0;
+}
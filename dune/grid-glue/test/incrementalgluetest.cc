@@ -0,0 +1,188 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dune/grid/sgrid.hh>
+#include <dune/common/mpihelper.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#include <dune/grid-glue/extractors/extractorpredicate.hh>
+#include <dune/grid-glue/extractors/codim0extractor.hh>
+#include <dune/grid-glue/adapter/gridglue.hh>
+
+#include <dune/grid-glue/merging/overlappingmerge.hh>
+
+#include <dune/grid-glue/test/couplingtest.hh>
+#include <dune/grid-glue/test/patchtest.hh>
+
+using namespace Dune;
+
+/*
+   We glue two overlapping cube grids, of which only the elements left of a
+   threshold are extracted.  The thresholds are moved, one or both extractors
+   are updated and only the changed intersections are recomputed by
+   buildIncremental().  The result has to be the same as a complete build of a
+   new GridGlue, also if a patch has been updated twice since the last build.
+ */
+
+typedef std::pair<ElementPair, double> IntersectionKey;
+
+/** \brief The elements and the volume of each intersection, by intersection index */
+template <class GlueType>
+std::vector<IntersectionKey> intersectionKeys(const GlueType& glue)
+{
+  typedef MultipleCodimMultipleGeomTypeMapper< typename GlueType::Grid0View, MCMGElementLayout > View0Mapper;
+  typedef MultipleCodimMultipleGeomTypeMapper< typename GlueType::Grid1View, MCMGElementLayout > View1Mapper;
+  View0Mapper view0mapper(glue.template gridView<0>());
+  View1Mapper view1mapper(glue.template gridView<1>());
+
+  std::vector<IntersectionKey> keys;
+  for (unsigned int i = 0; i < glue.size(); ++i)
+  {
+    const typename GlueType::Intersection is = glue.template getIntersection<0>(i);
+    keys.push_back(IntersectionKey(ElementPair(view0mapper.map(*is.inside()), view1mapper.map(*is.outside())),
+                                   is.geometry().volume()));
+  }
+  return keys;
+}
+
+/**
+ * \brief build incrementally and compare with a complete build of a new GridGlue
+ *
+ * The kept intersections have to be the ones with their previous index.
+ * If nothing has changed, all intersections have to be kept.
+ */
+template <int dim, class GlueType>
+bool compareWithCompleteBuild(GlueType& glue, const std::string& step, bool unchanged = false)
+{
+  const std::vector<IntersectionKey> before = intersectionKeys(glue);
+  glue.buildIncremental();
+  const std::vector<IntersectionKey> after = intersectionKeys(glue);
+
+  std::vector<int> old2new;
+  glue.getIntersectionMapping(old2new);
+  assert(old2new.size() == before.size());
+  unsigned int kept = 0;
+  for (unsigned int i = 0; i < after.size(); ++i)
+  {
+    const int previous = glue.previousIntersectionIndex(i);
+    if (previous < 0)
+      continue;
+    assert(std::size_t(previous) < before.size() && old2new[previous] == int(i));
+    assert(after[i].first == before[previous].first);
+    assert(std::abs(after[i].second - before[previous].second) < 1e-12);
+    ++kept;
+  }
+  assert(!unchanged || (kept == before.size() && kept == after.size()));
+
+  OverlappingMerge<dim,double> referenceMerger;
+  GlueType reference(glue.template patch<0>(), glue.template patch<1>(), &referenceMerger);
+  reference.build();
+
+  std::cout << step << ": incremental build " << glue.size()
+            << " intersections, complete build " << reference.size() << std::endl;
+
+  testCoupling(glue);
+  return sameIntersections(glue, reference);
+}
+
+template <int dim>
+bool testIncrementalBuild(const FieldVector<double,dim>& gridOffset)
+{
+  typedef SGrid<dim,dim> GridType;
+
+  FieldVector<int, dim> elements(10);
+  FieldVector<double,dim> lower(0);
+  FieldVector<double,dim> upper(1);
+
+  GridType grid0(elements, lower, upper);
+
+  lower += gridOffset;
+  upper += gridOffset;
+
+  GridType grid1(elements, lower, upper);
+
+  typedef typename GridType::LeafGridView DomGridView;
+  typedef typename GridType::LeafGridView TarGridView;
+
+  typedef Codim0Extractor<DomGridView> DomExtractor;
+  typedef Codim0Extractor<TarGridView> TarExtractor;
+
+  LeftOfDescriptor<DomGridView> domdesc(0.5);
+  LeftOfDescriptor<TarGridView> tardesc(0.75);
+
+  DomExtractor domEx(grid0.leafView(), domdesc);
+  TarExtractor tarEx(grid1.leafView(), tardesc);
+  domEx.trackChanges() = true;
+  tarEx.trackChanges() = true;
+  domEx.update(domdesc);
+  tarEx.update(tardesc);
+
+  typedef ::GridGlue<DomExtractor,TarExtractor> GlueType;
+
+  OverlappingMerge<dim,double> merger;
+  GlueType glue(domEx, tarEx, &merger);
+  // the kept intersections are sorted together with the new ones
+  glue.setIntersectionOrdering(GlueType::MortonOrdering);
+  glue.build();
+  assert(glue.size() > 0);
+
+  bool passed = true;
+
+  // grow the domain patch, then shrink both patches
+  const double thresholds[][2] = { {0.8, 0.75}, {0.3, 0.6} };
+  for (int step = 0; step < 2; ++step)
+  {
+    domdesc.threshold_ = thresholds[step][0];
+    tardesc.threshold_ = thresholds[step][1];
+    domEx.update(domdesc);
+    tarEx.update(tardesc);
+
+    // the leftmost elements are kept, the ones at the threshold come or go
+    std::vector<unsigned int> changed, removed;
+    domEx.getChangedSubEntities(changed);
+    domEx.getRemovedSubEntities(removed);
+    assert(!changed.empty() || !removed.empty());
+    assert(domEx.previousIndex(0) >= 0);
+
+    passed = passed && compareWithCompleteBuild<dim>(glue, "both patches changed");
+  }
+
+  // only one patch changes, the other one keeps the subentities of the last build
+  domdesc.threshold_ = 0.6;
+  domEx.update(domdesc);
+  passed = passed && compareWithCompleteBuild<dim>(glue, "domain patch changed");
+
+  tardesc.threshold_ = 0.7;
+  tarEx.update(tardesc);
+  passed = passed && compareWithCompleteBuild<dim>(glue, "target patch changed");
+
+  // nothing changes
+  passed = passed && compareWithCompleteBuild<dim>(glue, "no patch changed", true);
+
+  // two updates since the last build, the changes are only known relative to the second one
+  domdesc.threshold_ = 0.4;
+  domEx.update(domdesc);
+  domdesc.threshold_ = 0.5;
+  domEx.update(domdesc);
+  passed = passed && compareWithCompleteBuild<dim>(glue, "domain patch updated twice");
+
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  bool passed = true;
+  passed = passed && testIncrementalBuild<1>(FieldVector<double,1>(0.05));
+  passed = passed && testIncrementalBuild<2>(FieldVector<double,2>(0.05));
+
+  return passed ? 0 : 1;
+}
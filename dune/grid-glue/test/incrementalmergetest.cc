@@ -0,0 +1,105 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <utility>
+
+#include <dune/grid-glue/merging/overlappingmerge.hh>
+
+/*
+   We merge two non-matching 1d grids, then mark single elements of either
+   grid as changed and recompute only their intersections.  Together with the
+   intersections of the unchanged elements they have to give the full merged grid.
+ */
+
+typedef Dune::FieldVector<double,1> Coords;
+typedef std::pair<unsigned int, unsigned int> ElementPair;
+
+void fillGrid(int n, std::vector<Coords>& coords,
+              std::vector<unsigned int>& elements,
+              std::vector<Dune::GeometryType>& types)
+{
+  for (int i=0; i<=n; i++)
+    coords.push_back(Coords(double(i)/n));
+
+  for (int i=0; i<n; i++) {
+    elements.push_back(i);
+    elements.push_back(i+1);
+    types.push_back(Dune::GeometryType(Dune::GeometryType::simplex, 1));
+  }
+}
+
+std::map<ElementPair, int> countPairs(const Merger<double,1,1,1>& merger)
+{
+  std::map<ElementPair, int> pairs;
+  for (unsigned int i=0; i<merger.nSimplices(); i++)
+    pairs[ElementPair(merger.parent<0>(i), merger.parent<1>(i))]++;
+  return pairs;
+}
+
+int main ()
+{
+  int passed = true;
+
+  std::vector<Coords> grid1_coords;
+  std::vector<unsigned int> grid1_elements;
+  std::vector<Dune::GeometryType> grid1_element_types;
+  std::vector<Coords> grid2_coords;
+  std::vector<unsigned int> grid2_elements;
+  std::vector<Dune::GeometryType> grid2_element_types;
+
+  fillGrid(5, grid1_coords, grid1_elements, grid1_element_types);
+  fillGrid(7, grid2_coords, grid2_elements, grid2_element_types);
+
+  OverlappingMerge<1> merger;
+  assert(merger.supportsIncrementalBuild());
+
+  merger.build(grid1_coords, grid1_elements, grid1_element_types,
+               grid2_coords, grid2_elements, grid2_element_types);
+  const std::map<ElementPair, int> allPairs = countPairs(merger);
+  merger.clear();
+
+  // mark one element of grid 1 or grid 2 as changed
+  for (int side=0; side<2; side++) {
+
+    const unsigned int n = (side==0) ? grid1_element_types.size() : grid2_element_types.size();
+
+    for (unsigned int changed=0; changed<n; changed++) {
+
+      std::vector<bool> grid1_changed(grid1_element_types.size(), false);
+      std::vector<bool> grid2_changed(grid2_element_types.size(), false);
+      if (side==0)
+        grid1_changed[changed] = true;
+      else
+        grid2_changed[changed] = true;
+
+      std::vector<ElementPair> knownPairs;
+      std::map<ElementPair, int> expectedPairs;
+      for (std::map<ElementPair, int>::const_iterator it = allPairs.begin(); it != allPairs.end(); ++it) {
+        if (grid1_changed[it->first.first] || grid2_changed[it->first.second])
+          expectedPairs.insert(*it);
+        else
+          knownPairs.push_back(it->first);
+      }
+
+      merger.buildIncremental(grid1_coords, grid1_elements, grid1_element_types, grid1_changed,
+                              grid2_coords, grid2_elements, grid2_element_types, grid2_changed,
+                              knownPairs);
+
+      if (countPairs(merger) != expectedPairs) {
+        std::cerr << "Incremental merge with changed element " << changed
+                  << " of grid " << side+1 << " is incomplete" << std::endl;
+        passed = false;
+      }
+
+      merger.clear();
+    }
+
+  }
+
+  return passed ? 0 : 1;
+}
@@ -130,6 +130,7 @@ void testMatchingCubeGrids()
   // ///////////////////////////////////////////
 
   testCoupling(glue);
+  testIntersectionOrderings(glue);
 #else
     #warning Not testing, because psurface backend is not available.
 #endif
@@ -319,6 +320,26 @@ void testParallelCubeGrids()
 
   testCoupling(glue);
   testCommunication(glue);
+
+  // the ownership after the build and after distributing it evenly
+  testOwnership(glue);
+  glue.rebalanceOwnership();
+  testOwnership(glue);
+  testCoupling(glue);
+
+  // ...and by a weight that differs between the intersections
+  testRebalancing(glue);
+
+  // the same coupling, with the remote patches shared by the ranks of each node
+  SurfaceMergeImpl sharedMerger;
+  GlueType sharedGlue(domEx, tarEx, &sharedMerger);
+  sharedGlue.setNodeSharedPatches(true);
+  sharedGlue.build();
+  assert(sharedGlue.size() == glue.size());
+
+  testCoupling(sharedGlue);
+  testCommunication(sharedGlue);
+  testOwnership(sharedGlue);
 #else
     #warning Not testing, because psurface backend is not available.
 #endif
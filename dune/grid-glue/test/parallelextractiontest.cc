@@ -0,0 +1,175 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/mpihelper.hh>
+#include <dune/common/fvector.hh>
+#include <dune/grid/sgrid.hh>
+
+#include <dune/grid-glue/extractors/extractorpredicate.hh>
+#include <dune/grid-glue/extractors/codim0extractor.hh>
+#include <dune/grid-glue/extractors/codim1extractor.hh>
+
+#include <dune/grid-glue/test/patchtest.hh>
+
+using namespace Dune;
+
+/*
+   A patch extracted on several threads has to be the same as the one
+   extracted by a single thread, including the numbering of the vertices and
+   subentities and the mapping from the elements to their subentities.  An
+   exception thrown by the predicate on one of the threads has to reach the
+   caller of update().
+ */
+
+/** \brief Selects the boundary faces below a plane */
+template <class GridView>
+class LowerFacesDescriptor
+  : public ExtractorPredicate<GridView,1>
+{
+public:
+  virtual bool contains(const typename GridView::Traits::template Codim<0>::EntityPointer& element, unsigned int face) const
+  {
+    return element->geometry().center()[GridView::dimensionworld-1] < 0.6;
+  }
+};
+
+/** \brief Selects everything, but throws for the elements right of a threshold */
+template <class GridView, int codim>
+class ThrowingDescriptor
+  : public ExtractorPredicate<GridView,codim>
+{
+public:
+  ThrowingDescriptor(double threshold) : threshold_(threshold) {}
+
+  virtual bool contains(const typename GridView::Traits::template Codim<0>::EntityPointer& element, unsigned int subentity) const
+  {
+    if (element->geometry().center()[0] > threshold_)
+      DUNE_THROW(RangeError, "element right of x=" << threshold_);
+    return true;
+  }
+
+  double threshold_;
+};
+
+/** \brief whether update() passes the exception of a predicate on */
+template <class Extractor, class Descriptor>
+bool passesExceptionOn(Extractor& extractor, const Descriptor& descr)
+{
+  try
+  {
+    extractor.update(descr);
+  }
+  catch (Dune::Exception&)
+  {
+    return true;
+  }
+  return false;
+}
+
+/** \brief compare the coordinates, the faces and faceIndices() of two extractors */
+template <class Extractor>
+void comparePatches(const Extractor& serial, const Extractor& parallel)
+{
+  typedef typename Extractor::GridView GridView;
+  typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+
+  assert(identicalPatch(serial, parallel));
+  assert(serial.nSubEntities() > 0);
+
+  std::vector<GeometryType> serialTypes, parallelTypes;
+  serial.getGeometryTypes(serialTypes);
+  parallel.getGeometryTypes(parallelTypes);
+  assert(serialTypes == parallelTypes);
+
+  const GridView & gv = serial.gridView();
+  for (ElementIterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+  {
+    int serialFirst = -1, serialCount = -1;
+    int parallelFirst = -1, parallelCount = -1;
+    const bool serialHas = serial.faceIndices(*it, serialFirst, serialCount);
+    const bool parallelHas = parallel.faceIndices(*it, parallelFirst, parallelCount);
+    assert(serialHas == parallelHas);
+    if (serialHas)
+      assert(serialFirst == parallelFirst && serialCount == parallelCount);
+  }
+}
+
+template <class Extractor, class Descriptor>
+void testParallelExtraction(const typename Extractor::GridView& gv, const Descriptor& descr)
+{
+  Extractor serial(gv, descr);
+
+  Extractor parallel(gv, descr);
+  parallel.parallelExtraction() = true;
+  parallel.update(descr);
+  comparePatches(serial, parallel);
+
+  // again, so that both go through the same number of updates
+  serial.update(descr);
+  parallel.update(descr);
+  comparePatches(serial, parallel);
+}
+
+template <class Extractor>
+void testThrowingPredicate(const typename Extractor::GridView& gv)
+{
+  typedef typename Extractor::GridView GridView;
+  ThrowingDescriptor<GridView, Extractor::codim> descr(2.0);
+
+  Extractor extractor(gv, descr);
+  extractor.parallelExtraction() = true;
+  assert(!passesExceptionOn(extractor, descr));
+
+  // the last chunks throw
+  descr.threshold_ = 0.9;
+  assert(passesExceptionOn(extractor, descr));
+}
+
+template <int dim>
+void testGrid(int n)
+{
+  typedef SGrid<dim,dim> GridType;
+  typedef typename GridType::LeafGridView GridView;
+
+  FieldVector<int,dim> elements(n);
+  FieldVector<double,dim> lower(0);
+  FieldVector<double,dim> upper(1);
+  GridType grid(elements, lower, upper);
+
+  std::cout << "testing the parallel extraction on a " << dim << "d grid" << std::endl;
+  testParallelExtraction<Codim0Extractor<GridView> >(grid.leafView(), LeftOfDescriptor<GridView>(0.6));
+  testParallelExtraction<Codim1Extractor<GridView> >(grid.leafView(), LowerFacesDescriptor<GridView>());
+
+  testThrowingPredicate<Codim0Extractor<GridView> >(grid.leafView());
+  testThrowingPredicate<Codim1Extractor<GridView> >(grid.leafView());
+}
+
+int main(int argc, char** argv)
+{
+  MPIHelper::instance(argc, argv);
+
+#ifdef _OPENMP
+  // the chunks have to be extracted on more than one thread
+  if (omp_get_max_threads() < 2)
+    omp_set_num_threads(2);
+  std::cout << "extracting on " << omp_get_max_threads() << " threads" << std::endl;
+#else
+  std::cout << "OpenMP is not enabled, extracting on one thread" << std::endl;
+#endif
+
+  // enough elements for several chunks
+  testGrid<2>(40);
+  testGrid<3>(12);
+
+  return 0;
+}
@@ -0,0 +1,164 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include <dune/common/mpihelper.hh>
+#include <dune/common/fvector.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/grid-glue/extractors/extractorpredicate.hh>
+#include <dune/grid-glue/extractors/codim0extractor.hh>
+#include <dune/grid-glue/extractors/codim1extractor.hh>
+#include <dune/grid-glue/extractors/parallelextractor.hh>
+
+#include <dune/grid-glue/test/patchtest.hh>
+
+using namespace Dune;
+
+/*
+   The local patches of a distributed grid are extracted by ParallelExtractor,
+   through all overloads of update() and refreshCoordinates().  After each of
+   them the patch may only contain subentities of interior elements and the
+   tables of the shared vertices have to fit the patch.
+ */
+
+/** \brief check that the patch only contains interior elements and that the shared vertices fit it */
+template <class Extractor>
+void checkPatch(const Extractor& extractor)
+{
+  typedef typename Extractor::GridView GridView;
+  const GridView & gv = extractor.gridView();
+  const int rank = gv.comm().rank();
+
+  std::vector<typename Extractor::VertexVector> faces;
+  extractor.getFaces(faces);
+  for (unsigned int i = 0; i < faces.size(); ++i)
+    assert(extractor.element(i)->partitionType() == InteriorEntity);
+
+  const std::vector<int> & neighbors = extractor.neighborRanks();
+  for (unsigned int i = 0; i < extractor.nCoords(); ++i)
+  {
+    assert(extractor.globalVertexId(i) == gv.grid().globalIdSet().id(*extractor.vertex(i)));
+
+    const std::vector<int> & ranks = extractor.sharingRanks(i);
+    assert(extractor.isShared(i) == !ranks.empty());
+    for (unsigned int k = 0; k < ranks.size(); ++k)
+    {
+      assert(ranks[k] >= 0 && ranks[k] < gv.comm().size() && ranks[k] != rank);
+      assert(k == 0 || ranks[k-1] < ranks[k]);
+      assert(std::binary_search(neighbors.begin(), neighbors.end(), ranks[k]));
+    }
+  }
+}
+
+/** \brief the number of coordinates and faces of the patch */
+template <class Extractor>
+std::pair<unsigned int, unsigned int> patchSize(const Extractor& extractor)
+{
+  std::vector<typename Extractor::VertexVector> faces;
+  extractor.getFaces(faces);
+  return std::make_pair(extractor.nCoords(), (unsigned int)faces.size());
+}
+
+template <class GridView>
+void testCodim0(const GridView& gv)
+{
+  typedef ParallelExtractor<Codim0Extractor<GridView> > Extractor;
+
+  LeftOfDescriptor<GridView> descr(0.5);
+  Extractor extractor(gv, descr);
+  checkPatch(extractor);
+  const std::pair<unsigned int, unsigned int> left = patchSize(extractor);
+
+  // the callable selects the same elements
+  extractor.update(LeftOf(0.5));
+  checkPatch(extractor);
+  assert(patchSize(extractor) == left);
+
+  // grow the patch incrementally, then compare with a complete update
+  descr.threshold_ = 0.75;
+  extractor.update(descr, allElements(gv));
+  checkPatch(extractor);
+  const std::pair<unsigned int, unsigned int> incremental = patchSize(extractor);
+  extractor.update(descr);
+  checkPatch(extractor);
+  assert(patchSize(extractor) == incremental);
+
+  // and shrink it again with the callable
+  extractor.update(LeftOf(0.5), allElements(gv));
+  checkPatch(extractor);
+  assert(patchSize(extractor) == left);
+
+  extractor.refreshCoordinates();
+  checkPatch(extractor);
+  assert(patchSize(extractor) == left);
+}
+
+template <class GridView>
+void testCodim1(const GridView& gv)
+{
+  typedef ParallelExtractor<Codim1Extractor<GridView> > Extractor;
+
+  RightFaceDescriptor<GridView> descr;
+  Extractor extractor(gv, descr);
+  checkPatch(extractor);
+  const std::pair<unsigned int, unsigned int> right = patchSize(extractor);
+
+  extractor.update(RightFace());
+  checkPatch(extractor);
+  assert(patchSize(extractor) == right);
+
+  extractor.update(RightFace(), allElements(gv));
+  checkPatch(extractor);
+  assert(patchSize(extractor) == right);
+
+  // the boundary faces of the interior elements with the given ids
+  std::vector<int> ids(1, 1);
+  ids.push_back(2);
+  const BoundaryIdPredicate boundaryIds(ids);
+  unsigned int expected = 0;
+  typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+  typedef typename GridView::IntersectionIterator IntersectionIterator;
+  for (ElementIterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+    if (it->partitionType() == InteriorEntity)
+      for (IntersectionIterator iit = gv.ibegin(*it); iit != gv.iend(*it); ++iit)
+        if (iit->boundary() && boundaryIds(*iit))
+          expected += (GridView::dimension == 3) ? 2 : 1;
+
+  extractor.update(boundaryIds);
+  checkPatch(extractor);
+  assert(patchSize(extractor).second == expected);
+
+  extractor.update(boundaryIds, allElements(gv));
+  checkPatch(extractor);
+  assert(patchSize(extractor).second == expected);
+
+  extractor.update(descr, allElements(gv));
+  checkPatch(extractor);
+  assert(patchSize(extractor) == right);
+
+  extractor.refreshCoordinates();
+  checkPatch(extractor);
+  assert(patchSize(extractor) == right);
+}
+
+int main(int argc, char** argv)
+{
+  MPIHelper& mpiHelper = MPIHelper::instance(argc, argv);
+
+  typedef YaspGrid<2> GridType;
+  FieldVector<double,2> size(1);
+  FieldVector<int,2> elements(8);
+  FieldVector<bool,2> periodic(false);
+  GridType grid(mpiHelper.getCommunicator(), size, elements, periodic, 1);
+
+  testCodim0(grid.leafView());
+  testCodim1(grid.leafView());
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <iostream>
+#include <vector>
+
+#include <dune/grid-glue/common/patchmessage.hh>
+
+/*
+   We pack a small 2d patch with triangles and quadrilaterals into a message
+   and check that unpacking it gives back the same patch, and that the
+   message is smaller than the raw arrays.
+ */
+
+typedef Dune::FieldVector<double,2> Coords;
+
+int main ()
+{
+  int passed = true;
+
+  std::vector<Coords> coords;
+  std::vector<unsigned int> entities;
+  std::vector<Dune::GeometryType> types;
+
+  // a strip of n quadrilaterals, followed by a strip of 2n triangles
+  const unsigned int n = 100;
+  for (unsigned int j=0; j<3; j++)
+    for (unsigned int i=0; i<=n; i++) {
+      Coords c;
+      c[0] = double(i)/n;
+      c[1] = j;
+      coords.push_back(c);
+    }
+
+  for (unsigned int i=0; i<n; i++) {
+    entities.push_back(i);
+    entities.push_back(i+1);
+    entities.push_back(i+n+1);
+    entities.push_back(i+n+2);
+    types.push_back(Dune::GeometryType(Dune::GeometryType::cube, 2));
+  }
+  for (unsigned int i=n+1; i<2*n+1; i++) {
+    entities.push_back(i);
+    entities.push_back(i+1);
+    entities.push_back(i+n+1);
+    types.push_back(Dune::GeometryType(Dune::GeometryType::simplex, 2));
+    entities.push_back(i+1);
+    entities.push_back(i+n+2);
+    entities.push_back(i+n+1);
+    types.push_back(Dune::GeometryType(Dune::GeometryType::simplex, 2));
+  }
+
+  typedef Dune::GridGlue::PatchMessage<double,2> Message;
+  std::vector<char> buffer;
+  Message::pack(coords, entities, types, buffer);
+
+  std::vector<Coords> coords2;
+  std::vector<unsigned int> entities2;
+  std::vector<Dune::GeometryType> types2;
+  Message::unpack(buffer, coords2, entities2, types2);
+
+  if (coords2 != coords || entities2 != entities || types2 != types) {
+    std::cerr << "Unpacked patch differs from the packed one" << std::endl;
+    passed = false;
+  }
+
+  const std::size_t rawSize = coords.size()*sizeof(Coords)
+                              + entities.size()*sizeof(unsigned int)
+                              + types.size()*sizeof(Dune::GeometryType);
+  std::cout << "Patch message has " << buffer.size() << " bytes, the raw arrays have "
+            << rawSize << " bytes" << std::endl;
+  if (buffer.size() >= rawSize) {
+    std::cerr << "Patch message is not smaller than the raw arrays" << std::endl;
+    passed = false;
+  }
+
+  // an empty patch
+  Message::pack(std::vector<Coords>(), std::vector<unsigned int>(),
+                std::vector<Dune::GeometryType>(), buffer);
+  Message::unpack(buffer, coords2, entities2, types2);
+  if (!coords2.empty() || !entities2.empty() || !types2.empty()) {
+    std::cerr << "Unpacked empty patch is not empty" << std::endl;
+    passed = false;
+  }
+
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef GRIDGLUE_PATCHTEST_HH
+#define GRIDGLUE_PATCHTEST_HH
+
+/*
+   Predicates and comparisons of patches and of merged grids, shared by the
+   tests of the extractors and of the updates of GridGlue.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <dune/geometry/genericreferenceelements.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#include <dune/grid-glue/extractors/extractorpredicate.hh>
+
+/** \brief Selects the elements whose center lies left of a threshold */
+template <class GridView>
+class LeftOfDescriptor
+  : public ExtractorPredicate<GridView,0>
+{
+public:
+  LeftOfDescriptor(double threshold) : threshold_(threshold) {}
+
+  virtual bool contains(const typename GridView::Traits::template Codim<0>::EntityPointer& element, unsigned int subentity) const
+  {
+    return element->geometry().center()[0] < threshold_;
+  }
+
+  double threshold_;
+};
+
+/** \brief The same selection as a callable taking the element */
+struct LeftOf
+{
+  LeftOf(double threshold) : threshold_(threshold) {}
+
+  template<class Element>
+  bool operator() (const Element& element) const
+  {
+    return element.geometry().center()[0] < threshold_;
+  }
+
+  double threshold_;
+};
+
+/** \brief Selects the boundary faces at x=1 */
+template <class GridView>
+class RightFaceDescriptor
+  : public ExtractorPredicate<GridView,1>
+{
+public:
+  virtual bool contains(const typename GridView::Traits::template Codim<0>::EntityPointer& element, unsigned int face) const
+  {
+    const int dim = GridView::dimension;
+    const Dune::GenericReferenceElement<double,dim>& refElement = Dune::GenericReferenceElements<double,dim>::general(element->type());
+    return std::abs(element->geometry().global(refElement.position(face,1))[0] - 1.0) < 1e-6;
+  }
+};
+
+/** \brief The same selection as a callable taking the element and the intersection */
+struct RightFace
+{
+  template<class Element, class Intersection>
+  bool operator() (const Element& element, const Intersection& is) const
+  {
+    return std::abs(is.geometry().center()[0] - 1.0) < 1e-6;
+  }
+};
+
+/** \brief the seeds of all elements of the grid view */
+template <class GridView>
+std::vector<typename GridView::Grid::template Codim<0>::EntitySeed> allElements(const GridView& gv)
+{
+  std::vector<typename GridView::Grid::template Codim<0>::EntitySeed> seeds;
+  typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+  for (ElementIterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+    seeds.push_back(it->seed());
+  return seeds;
+}
+
+typedef std::vector<std::vector<double> > FaceCorners;
+
+/** \brief the corner coordinates of all subentities, independent of their numbering */
+template <class Extractor>
+std::multiset<FaceCorners> faceSet(const Extractor& extractor)
+{
+  std::vector<typename Extractor::Coords> coords;
+  extractor.getCoords(coords);
+  std::vector<typename Extractor::VertexVector> faces;
+  extractor.getFaces(faces);
+
+  std::multiset<FaceCorners> result;
+  for (unsigned int i = 0; i < faces.size(); ++i)
+  {
+    FaceCorners corners;
+    for (unsigned int j = 0; j < faces[i].size(); ++j)
+      corners.push_back(std::vector<double>(coords[faces[i][j]].begin(), coords[faces[i][j]].end()));
+    std::sort(corners.begin(), corners.end());
+    result.insert(corners);
+  }
+  return result;
+}
+
+/** \brief whether two extractors have the same vertices and faces, numbered the same way */
+template <class Extractor>
+bool identicalPatch(const Extractor& a, const Extractor& b)
+{
+  std::vector<typename Extractor::Coords> coordsA, coordsB;
+  a.getCoords(coordsA);
+  b.getCoords(coordsB);
+  std::vector<typename Extractor::VertexVector> facesA, facesB;
+  a.getFaces(facesA);
+  b.getFaces(facesB);
+  return coordsA == coordsB && facesA == facesB;
+}
+
+/**
+ * \brief whether two extractors have the same subentities, possibly numbered differently
+ *
+ * This compares e.g. an incrementally updated extractor with a complete update.
+ * The same elements have to have subentities, and as many.
+ */
+template <class Extractor>
+bool samePatch(const Extractor& a, const Extractor& b)
+{
+  typedef typename Extractor::GridView GridView;
+  typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+
+  if (a.nCoords() != b.nCoords() || faceSet(a) != faceSet(b))
+    return false;
+
+  const GridView & gv = b.gridView();
+  for (ElementIterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+  {
+    int firstA = -1, countA = -1;
+    int firstB = -1, countB = -1;
+    const bool has = a.faceIndices(*it, firstA, countA);
+    if (has != b.faceIndices(*it, firstB, countB))
+      return false;
+    if (has && countA != countB)
+      return false;
+  }
+  return true;
+}
+
+typedef std::pair<int, int> ElementPair;
+
+/** \brief The area of the intersections, per pair of elements */
+template <class GlueType>
+std::map<ElementPair, double> intersectionAreas(const GlueType& glue)
+{
+  typedef Dune::MultipleCodimMultipleGeomTypeMapper< typename GlueType::Grid0View, Dune::MCMGElementLayout > View0Mapper;
+  typedef Dune::MultipleCodimMultipleGeomTypeMapper< typename GlueType::Grid1View, Dune::MCMGElementLayout > View1Mapper;
+  View0Mapper view0mapper(glue.template gridView<0>());
+  View1Mapper view1mapper(glue.template gridView<1>());
+
+  std::map<ElementPair, double> areas;
+  typename GlueType::Grid0IntersectionIterator rIIt    = glue.template ibegin<0>();
+  typename GlueType::Grid0IntersectionIterator rIEndIt = glue.template iend<0>();
+  for (; rIIt!=rIEndIt; ++rIIt)
+    areas[ElementPair(view0mapper.map(*rIIt->inside()), view1mapper.map(*rIIt->outside()))]
+      += rIIt->geometry().volume();
+  return areas;
+}
+
+/** \brief whether two merged grids couple the same pairs of elements by the same areas */
+template <class GlueType>
+bool sameIntersections(const GlueType& glue, const GlueType& reference)
+{
+  const std::map<ElementPair, double> areas = intersectionAreas(glue);
+  const std::map<ElementPair, double> referenceAreas = intersectionAreas(reference);
+
+  if (areas.size() != referenceAreas.size())
+  {
+    std::cerr << "found " << areas.size() << " element pairs, "
+              << "the reference " << referenceAreas.size() << std::endl;
+    return false;
+  }
+
+  std::map<ElementPair, double>::const_iterator it = areas.begin();
+  std::map<ElementPair, double>::const_iterator refIt = referenceAreas.begin();
+  for (; it != areas.end(); ++it, ++refIt)
+    if (it->first != refIt->first || std::abs(it->second - refIt->second) > 1e-10)
+    {
+      std::cerr << "intersection of elements " << it->first.first << " and " << it->first.second
+                << " differs from the reference" << std::endl;
+      return false;
+    }
+  return true;
+}
+
+#endif // GRIDGLUE_PATCHTEST_HH
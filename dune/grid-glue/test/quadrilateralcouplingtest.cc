@@ -0,0 +1,134 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <dune/common/mpihelper.hh>
+#include <dune/common/fvector.hh>
+#include <dune/grid/sgrid.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#include <dune/grid-glue/extractors/extractorpredicate.hh>
+#include <dune/grid-glue/extractors/codim1extractor.hh>
+#include <dune/grid-glue/adapter/gridglue.hh>
+
+#include <dune/grid-glue/merging/conformingmerge.hh>
+#if HAVE_PSURFACE
+#include <dune/grid-glue/merging/psurfacemerge.hh>
+#endif
+
+#include <dune/grid-glue/test/couplingtest.hh>
+
+using namespace Dune;
+
+/*
+   Two hexahedral grids touch at the plane x=1.  With keepQuadrilaterals() the
+   patches consist of the quadrilateral boundary faces themselves, and the
+   remote intersections computed by the surface mergers have to cover each
+   of them exactly.
+ */
+
+/** \brief Selects the boundary faces in the plane x=1 */
+struct InterfaceFace
+{
+  template<class Element, class Intersection>
+  bool operator() (const Element& element, const Intersection& is) const
+  {
+    return std::abs(is.geometry().center()[0] - 1.0) < 1e-6;
+  }
+};
+
+/** \brief the area of the intersections per face (element index and face number) of patch 0 */
+template <class GlueType>
+std::map<std::pair<int,int>, double> coveredArea(const GlueType& glue)
+{
+  typedef MultipleCodimMultipleGeomTypeMapper< typename GlueType::Grid0View, MCMGElementLayout > View0Mapper;
+  View0Mapper view0mapper(glue.template gridView<0>());
+
+  std::map<std::pair<int,int>, double> areas;
+  typename GlueType::Grid0IntersectionIterator it = glue.template ibegin<0>();
+  typename GlueType::Grid0IntersectionIterator end = glue.template iend<0>();
+  for (; it != end; ++it)
+    areas[std::make_pair(view0mapper.map(*it->inside()), it->indexInInside())] += it->geometry().volume();
+  return areas;
+}
+
+template <class GlueType>
+void testCover(GlueType& glue, unsigned int nFaces, double faceArea)
+{
+  glue.build();
+  std::cout << "Gluing successful, " << glue.size() << " remote intersections found!" << std::endl;
+  assert(glue.size() >= nFaces);
+
+  const std::map<std::pair<int,int>, double> areas = coveredArea(glue);
+  assert(areas.size() == nFaces);
+  for (std::map<std::pair<int,int>, double>::const_iterator it = areas.begin(); it != areas.end(); ++it)
+    assert(std::abs(it->second - faceArea) < 1e-10);
+
+  testCoupling(glue);
+}
+
+void testHexahedralGrids(int n)
+{
+  const int dim = 3;
+  typedef SGrid<dim,dim> GridType;
+
+  FieldVector<int,dim> elements(n);
+  FieldVector<double,dim> lower(0);
+  FieldVector<double,dim> upper(1);
+  GridType grid0(elements, lower, upper);
+  lower[0] += 1;
+  upper[0] += 1;
+  GridType grid1(elements, lower, upper);
+
+  typedef GridType::LeafGridView GridView;
+  typedef Codim1Extractor<GridView> Extractor;
+
+  Extractor ex0(grid0.leafView(), InterfaceFace());
+  Extractor ex1(grid1.leafView(), InterfaceFace());
+  ex0.keepQuadrilaterals() = true;
+  ex1.keepQuadrilaterals() = true;
+  ex0.update(InterfaceFace());
+  ex1.update(InterfaceFace());
+
+  // one subentity per boundary quadrilateral
+  const unsigned int nFaces = n*n;
+  std::vector<GeometryType> types;
+  ex0.getGeometryTypes(types);
+  assert(types.size() == nFaces);
+  for (unsigned int i = 0; i < types.size(); ++i)
+    assert(types[i].isCube() && types[i].dim() == dim-1);
+  ex1.getGeometryTypes(types);
+  assert(types.size() == nFaces);
+
+  typedef ::GridGlue<Extractor,Extractor> GlueType;
+  const double faceArea = 1.0 / (n*n);
+
+  ConformingMerge<dim-1,dim,double> conformingMerger;
+  GlueType conformingGlue(ex0, ex1, &conformingMerger);
+  testCover(conformingGlue, nFaces, faceArea);
+  // each quadrilateral is split into two triangles
+  assert(conformingGlue.size() == 2*nFaces);
+
+#if HAVE_PSURFACE
+  PSurfaceMerge<dim-1,dim,double> psurfaceMerger;
+  GlueType psurfaceGlue(ex0, ex1, &psurfaceMerger);
+  testCover(psurfaceGlue, nFaces, faceArea);
+#endif
+}
+
+int main(int argc, char** argv)
+{
+  MPIHelper::instance(argc, argv);
+
+  testHexahedralGrids(1);
+  testHexahedralGrids(3);
+
+  return 0;
+}
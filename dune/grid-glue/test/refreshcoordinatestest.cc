@@ -0,0 +1,203 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/mpihelper.hh>
+#include <dune/common/fvector.hh>
+#include <dune/grid/sgrid.hh>
+#include <dune/grid/geometrygrid.hh>
+
+#include <dune/grid-glue/extractors/extractorpredicate.hh>
+#include <dune/grid-glue/extractors/codim0extractor.hh>
+#include <dune/grid-glue/adapter/gridglue.hh>
+
+#include <dune/grid-glue/merging/overlappingmerge.hh>
+
+#include <dune/grid-glue/test/couplingtest.hh>
+#include <dune/grid-glue/test/patchtest.hh>
+
+using namespace Dune;
+
+/*
+   We glue two overlapping cube grids.  The right half of the second grid is
+   stretched, its extractor reads the new positions by refreshCoordinates()
+   and reports the elements with a moved vertex as changed.  The intersections
+   of a rebuild and of an incremental build have to be the same as the ones of
+   a new GridGlue.  Positions that only the extractor has transformed are
+   reported as changed again by the next update().
+ */
+
+/** \brief Selects all elements */
+template <class GridView>
+class AllElementsDescriptor
+  : public ExtractorPredicate<GridView,0>
+{
+public:
+  virtual bool contains(const typename GridView::Traits::template Codim<0>::EntityPointer& element, unsigned int subentity) const
+  {
+    return true;
+  }
+};
+
+/** \brief Stretches the part of the domain right of x=0.5 by a variable factor */
+template <int dim>
+class StretchTrafo
+  : public AnalyticalCoordFunction< double, dim, dim, StretchTrafo<dim> >
+{
+public:
+  StretchTrafo(const double& stretch) : stretch_(&stretch) {}
+
+  //! evaluate method for global mapping
+  void evaluate ( const FieldVector<double, dim> &x, FieldVector<double, dim> &y ) const
+  {
+    y = x;
+    if (x[0] > 0.5 + 1e-8)
+      y[0] += *stretch_ * (x[0] - 0.5);
+  }
+
+private:
+  const double* stretch_;
+};
+
+/** \brief Shifts the positions right of x=0.5 upwards, for Extractor::refreshCoordinates() */
+template <class Coords>
+struct LiftRight
+{
+  Coords operator() (const Coords& x) const
+  {
+    Coords y = x;
+    if (x[0] > 0.5 + 1e-8)
+      y[1] += 0.01;
+    return y;
+  }
+};
+
+/** \brief whether the changed subentities are exactly the ones with a corner right of x=0.5 */
+template <class Extractor>
+bool changedRightHalf(const Extractor& extractor)
+{
+  std::vector<typename Extractor::Coords> coords;
+  extractor.getCoords(coords);
+  std::vector<typename Extractor::VertexVector> faces;
+  extractor.getFaces(faces);
+
+  std::vector<unsigned int> changed;
+  extractor.getChangedSubEntities(changed);
+  std::vector<char> isChanged(faces.size(), false);
+  for (unsigned int i = 0; i < changed.size(); ++i)
+    isChanged[changed[i]] = true;
+
+  unsigned int moved = 0;
+  for (unsigned int i = 0; i < faces.size(); ++i)
+  {
+    bool right = false;
+    for (unsigned int j = 0; j < faces[i].size(); ++j)
+      right = right || coords[faces[i][j]][0] > 0.5 + 1e-8;
+    if (right != bool(isChanged[i]))
+      return false;
+    if (right)
+      ++moved;
+  }
+  return moved > 0 && moved < faces.size();
+}
+
+template <int dim>
+void testRefreshCoordinates()
+{
+  typedef SGrid<dim,dim> GridType;
+  typedef GeometryGrid<GridType, StretchTrafo<dim> > StretchedGridType;
+
+  FieldVector<int, dim> elements(10);
+  FieldVector<double,dim> lower(0.05);
+  FieldVector<double,dim> upper(1.05);
+  GridType grid0(elements, lower, upper);
+
+  lower = 0;
+  upper = 1;
+  GridType hostGrid1(elements, lower, upper);
+  double stretch = 0;
+  StretchTrafo<dim> trafo(stretch);
+  StretchedGridType grid1(hostGrid1, trafo);
+
+  typedef typename GridType::LeafGridView DomGridView;
+  typedef typename StretchedGridType::LeafGridView TarGridView;
+
+  typedef Codim0Extractor<DomGridView> DomExtractor;
+  typedef Codim0Extractor<TarGridView> TarExtractor;
+
+  AllElementsDescriptor<DomGridView> domdesc;
+  AllElementsDescriptor<TarGridView> tardesc;
+
+  DomExtractor domEx(grid0.leafView(), domdesc);
+  TarExtractor tarEx(grid1.leafView(), tardesc);
+  domEx.trackChanges() = true;
+  tarEx.trackChanges() = true;
+  domEx.update(domdesc);
+  tarEx.update(tardesc);
+
+  typedef ::GridGlue<DomExtractor,TarExtractor> GlueType;
+
+  OverlappingMerge<dim,double> merger;
+  GlueType glue(domEx, tarEx, &merger);
+  glue.build();
+  assert(glue.size() > 0);
+
+  // move the vertices of the right half and read them again
+  stretch = 0.2;
+  tarEx.refreshCoordinates();
+  assert(changedRightHalf(tarEx));
+  std::vector<typename TarExtractor::Coords> coords;
+  tarEx.getCoords(coords);
+  for (unsigned int i = 0; i < coords.size(); ++i)
+    assert(tarEx.vertex(i)->geometry().corner(0) == coords[i]);
+
+  {
+    glue.buildIncremental();
+
+    OverlappingMerge<dim,double> referenceMerger;
+    GlueType reference(domEx, tarEx, &referenceMerger);
+    reference.build();
+
+    std::cout << "incremental build " << glue.size()
+              << " intersections, complete build " << reference.size() << std::endl;
+    assert(sameIntersections(glue, reference));
+    testCoupling(glue);
+  }
+
+  // once more, with a rebuild
+  stretch = 0.1;
+  tarEx.refreshCoordinates();
+  assert(changedRightHalf(tarEx));
+  {
+    glue.build();
+
+    OverlappingMerge<dim,double> referenceMerger;
+    GlueType reference(domEx, tarEx, &referenceMerger);
+    reference.build();
+
+    assert(sameIntersections(glue, reference));
+    testCoupling(glue);
+  }
+
+  // a transformation in the extractor moves the same subentities...
+  domEx.refreshCoordinates(LiftRight<typename DomExtractor::Coords>());
+  assert(changedRightHalf(domEx));
+
+  // ...and the next update reads the untransformed positions, so they change again
+  domEx.update(domdesc);
+  assert(changedRightHalf(domEx));
+}
+
+int main(int argc, char** argv)
+{
+  MPIHelper::instance(argc, argv);
+
+  // OverlappingMerge only handles two dimensions
+  testRefreshCoordinates<2>();
+
+  return 0;
+}
@@ -0,0 +1,163 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/mpihelper.hh>
+#include <dune/common/fvector.hh>
+#include <dune/geometry/genericreferenceelements.hh>
+#include <dune/grid/sgrid.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#include <dune/grid-glue/extractors/extractorpredicate.hh>
+#include <dune/grid-glue/extractors/codim0extractor.hh>
+#include <dune/grid-glue/extractors/codim1extractor.hh>
+
+#include <dune/grid-glue/test/patchtest.hh>
+
+using namespace Dune;
+
+/*
+   With spatialOrdering() the vertices and subentities are numbered along a
+   space-filling curve.  The patch has to consist of the same subentities as
+   without it, and the mappings between the patch and the grid, i.e.
+   faceIndices(), element(), vertex() and indexInInside(), have to fit the
+   new numbering, also after an incremental update.
+ */
+
+/** \brief Selects the boundary faces whose center lies left of a threshold */
+template <class GridView>
+class LeftFacesDescriptor
+  : public ExtractorPredicate<GridView,1>
+{
+public:
+  LeftFacesDescriptor(double threshold) : threshold_(threshold) {}
+
+  virtual bool contains(const typename GridView::Traits::template Codim<0>::EntityPointer& element, unsigned int face) const
+  {
+    const int dim = GridView::dimension;
+    const GenericReferenceElement<double,dim>& refElement = GenericReferenceElements<double,dim>::general(element->type());
+    return element->geometry().global(refElement.position(face,1))[0] < threshold_;
+  }
+
+  double threshold_;
+};
+
+/** \brief check that faceIndices(), element(), vertex() and indexInInside() fit the patch */
+template <class Extractor>
+void checkMappings(const Extractor& extractor)
+{
+  typedef typename Extractor::GridView GridView;
+  typedef typename Extractor::Coords Coords;
+  typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+  typedef MultipleCodimMultipleGeomTypeMapper<GridView, MCMGElementLayout> ElementMapper;
+  const int dim = GridView::dimension;
+
+  const GridView & gv = extractor.gridView();
+  ElementMapper mapper(gv);
+
+  std::vector<Coords> coords;
+  extractor.getCoords(coords);
+  std::vector<typename Extractor::VertexVector> faces;
+  extractor.getFaces(faces);
+
+  // every coordinate is the position of its vertex
+  for (unsigned int i = 0; i < coords.size(); ++i)
+    assert(extractor.vertex(i)->geometry().corner(0) == coords[i]);
+
+  // the subentities of an element are the ones faceIndices() gives
+  std::vector<int> owner(faces.size(), -1);
+  for (ElementIterator it = gv.template begin<0>(); it != gv.template end<0>(); ++it)
+  {
+    int first = -1, count = -1;
+    if (!extractor.faceIndices(*it, first, count))
+      continue;
+    assert(count > 0 && first >= 0 && std::size_t(first + count) <= faces.size());
+    for (int i = first; i < first + count; ++i)
+    {
+      assert(owner[i] < 0);
+      owner[i] = mapper.map(*it);
+    }
+  }
+
+  for (unsigned int i = 0; i < faces.size(); ++i)
+  {
+    // ...and element() gives the same element
+    assert(owner[i] >= 0 && owner[i] == mapper.map(*extractor.element(i)));
+
+    // the corners of the subentity are corners of its subentity of the element
+    const typename Extractor::ElementPtr element = extractor.element(i);
+    const GenericReferenceElement<double,dim>& refElement = GenericReferenceElements<double,dim>::general(element->type());
+    const int codim = Extractor::codim;
+    const int sub = (codim == 0) ? 0 : extractor.indexInInside(i);
+    for (unsigned int j = 0; j < faces[i].size(); ++j)
+    {
+      bool found = false;
+      for (int k = 0; k < refElement.size(sub, codim, dim); ++k)
+        found = found || element->geometry().corner(refElement.subEntity(sub, codim, k, dim)) == coords[faces[i][j]];
+      assert(found);
+    }
+  }
+}
+
+/** \brief compare the patches of an extractor with and without spatialOrdering() */
+template <class Extractor>
+void compareOrderings(const Extractor& plain, const Extractor& ordered)
+{
+  checkMappings(plain);
+  checkMappings(ordered);
+
+  // the same subentities, numbered differently
+  assert(samePatch(plain, ordered));
+  assert(plain.nSubEntities() > 0);
+}
+
+template <class Extractor, class Descriptor>
+void testSpatialOrdering(const typename Extractor::GridView& gv, Descriptor descr)
+{
+  Extractor plain(gv, descr);
+  Extractor ordered(gv, descr);
+  ordered.spatialOrdering() = true;
+  ordered.update(descr);
+  compareOrderings(plain, ordered);
+
+  // the incremental update appends to the ordered patch
+  descr.threshold_ = 0.8;
+  plain.update(descr, allElements(gv));
+  ordered.update(descr, allElements(gv));
+  compareOrderings(plain, ordered);
+
+  // and the next complete update orders it again
+  plain.update(descr);
+  ordered.update(descr);
+  compareOrderings(plain, ordered);
+}
+
+template <int dim>
+void testGrid(int n)
+{
+  typedef SGrid<dim,dim> GridType;
+  typedef typename GridType::LeafGridView GridView;
+
+  FieldVector<int,dim> elements(n);
+  FieldVector<double,dim> lower(0);
+  FieldVector<double,dim> upper(1);
+  GridType grid(elements, lower, upper);
+
+  std::cout << "testing the spatial ordering on a " << dim << "d grid" << std::endl;
+  testSpatialOrdering<Codim0Extractor<GridView> >(grid.leafView(), LeftOfDescriptor<GridView>(0.5));
+  testSpatialOrdering<Codim1Extractor<GridView> >(grid.leafView(), LeftFacesDescriptor<GridView>(0.5));
+}
+
+int main(int argc, char** argv)
+{
+  MPIHelper::instance(argc, argv);
+
+  testGrid<2>(8);
+  testGrid<3>(4);
+
+  return 0;
+}
@@ -1,6 +1,12 @@
 # Additional checks needed to build the module
 AC_DEFUN([DUNE_GRID_GLUE_CHECKS],[
     AC_REQUIRE([DUNE_PATH_PSURFACE])
+
+    # parallelFor() runs on several threads if OpenMP is enabled,
+    # compile and link with $(OPENMP_CXXFLAGS) to use it
+    AC_LANG_PUSH([C++])
+    AC_OPENMP
+    AC_LANG_POP([C++])
 ])
 
 